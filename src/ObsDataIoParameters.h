@@ -93,6 +93,27 @@ class ObsDataOutParameters : public oops::Parameters {
  public:
     /// option controlling the creation of the backend
     oops::RequiredParameter<Engines::WriterParametersWrapper> engine{"engine", this};
+
+    /// write the output file on a background thread (falls back to a regular save if
+    /// the MPI or HDF5 library does not support multi-threaded use)
+    oops::Parameter<bool> asynchronousSave{"asynchronous save", false, this};
+
+    /// on saves after the first, update the existing output file by writing only the
+    /// variables modified (by put_db) since the previous save
+    oops::Parameter<bool> incrementalSave{"incremental save", false, this};
+
+    /// glob patterns (e.g. "MetaData/*") selecting the variables to be written, matched
+    /// against the variable names including their group (all variables if empty)
+    oops::Parameter<std::vector<std::string>> includeVariables{"include variables", {}, this};
+
+    /// glob patterns selecting variables not to be written (applied after "include variables")
+    oops::Parameter<std::vector<std::string>> excludeVariables{"exclude variables", {}, this};
+
+    /// drop the locations where all of the QC flags in "qc group" take one of these values
+    oops::Parameter<std::vector<int>> dropQcFlags{"drop qc flags", {}, this};
+
+    /// group holding the QC flags used by "drop qc flags"
+    oops::Parameter<std::string> qcGroup{"qc group", "EffectiveQC", this};
 };
 
 }  // namespace ioda
@@ -27,6 +27,7 @@
 
 #include "ioda/distribution/Accumulator.h"
 #include "ioda/distribution/DistributionUtils.h"
+#include "ioda/distribution/ReductionBatch.h"
 #include "ioda/ObsSpace.h"
 #include "ioda/ObsVector.h"
 
@@ -271,14 +272,18 @@ template <typename DATATYPE>
 void printNonnumericObsDataVectorStats(const ObsDataVector<DATATYPE> &obsdatavector,
                                        const ObsSpace &obsdb,
                                        std::ostream & os) {
-  for (size_t jv = 0; jv < obsdatavector.nvars(); ++jv) {
-    int nloc = obsdb.globalNumLocs();
-    // collect nobs on all processors
-    int nobs = globalNumNonMissingObs(*obsdb.distribution(),
-                                      obsdatavector.nvars(), obsdatavector[jv]);
+  // collect nobs of all variables on all processors at once
+  ReductionBatch batch(*obsdb.distribution());
+  std::vector<std::size_t> nobs(obsdatavector.nvars());
+  for (size_t jv = 0; jv < obsdatavector.nvars(); ++jv)
+    globalNumNonMissingObs(batch, *obsdb.distribution(),
+                           obsdatavector.nvars(), obsdatavector[jv], nobs[jv]);
+  batch.execute();
 
+  int nloc = obsdb.globalNumLocs();
+  for (size_t jv = 0; jv < obsdatavector.nvars(); ++jv) {
     os << obsdb.obsname() << " " << obsdatavector.varnames()[jv] << " nlocs = " << nloc
-       << ", nobs = " << nobs << std::endl;
+       << ", nobs = " << nobs[jv] << std::endl;
   }
 }
 // -----------------------------------------------------------------------------
@@ -294,32 +299,40 @@ void printNumericObsDataVectorStats(const ObsDataVector<DATATYPE> &obsdatavector
                                     const ObsSpace &obsdb,
                                     std::ostream & os) {
   const DATATYPE missing = util::missingValue(missing);
-  for (size_t jv = 0; jv < obsdatavector.nvars(); ++jv) {
-    DATATYPE zmin = std::numeric_limits<DATATYPE>::max();
-    DATATYPE zmax = std::numeric_limits<DATATYPE>::lowest();
+  const size_t nvars = obsdatavector.nvars();
+  std::vector<DATATYPE> zmin(nvars, std::numeric_limits<DATATYPE>::max());
+  std::vector<DATATYPE> zmax(nvars, std::numeric_limits<DATATYPE>::lowest());
+  std::vector<DATATYPE> zsum(nvars);
+  std::vector<std::size_t> nobs(nvars);
+  // collect zmin, zmax, zavg, globalNumNonMissingObs of all variables on all processors at once
+  ReductionBatch batch(*obsdb.distribution());
+  for (size_t jv = 0; jv < nvars; ++jv) {
     std::unique_ptr<Accumulator<DATATYPE>> accumulator =
         obsdb.distribution()->createAccumulator<DATATYPE>();
-    int nloc = obsdb.globalNumLocs();
 
     const std::vector<DATATYPE> &vector = obsdatavector[jv];
     for (size_t jj = 0; jj < obsdatavector.nlocs(); ++jj) {
       DATATYPE zz = vector.at(jj);
       if (zz != missing) {
-        if (zz < zmin) zmin = zz;
-        if (zz > zmax) zmax = zz;
+        if (zz < zmin[jv]) zmin[jv] = zz;
+        if (zz > zmax[jv]) zmax[jv] = zz;
         accumulator->addTerm(jj, zz);
       }
     }
-    // collect zmin, zmax, zavg, globalNumNonMissingObs on all processors
-    obsdb.distribution()->min(zmin);
-    obsdb.distribution()->max(zmax);
-    DATATYPE zsum = accumulator->computeResult();
-    int nobs = globalNumNonMissingObs(*obsdb.distribution(), 1, vector);
+    batch.sum(*accumulator, zsum[jv]);
+    globalNumNonMissingObs(batch, *obsdb.distribution(), 1, vector, nobs[jv]);
+  }
+  batch.min(zmin);
+  batch.max(zmax);
+  batch.execute();
 
+  int nloc = obsdb.globalNumLocs();
+  for (size_t jv = 0; jv < nvars; ++jv) {
     os << std::endl << obsdb.obsname() << " " << obsdatavector.varnames()[jv]
-       << " nlocs = " << nloc << ", nobs = " << nobs;
-    if (nobs > 0) {
-      os << ", min = " << zmin << ", max = " << zmax << ", avg = " << zsum/nobs;
+       << " nlocs = " << nloc << ", nobs = " << nobs[jv];
+    if (nobs[jv] > 0) {
+      os << ", min = " << zmin[jv] << ", max = " << zmax[jv]
+         << ", avg = " << zsum[jv]/static_cast<DATATYPE>(nobs[jv]);
     } else {
       os << " : No observations.";
     }
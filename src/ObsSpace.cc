@@ -7,13 +7,20 @@
 
 #include "ioda/ObsSpace.h"
 
+#include <fnmatch.h>
+
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <map>
 #include <memory>
+#include <numeric>
 #include <set>
+#include <shared_mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -34,11 +41,16 @@
 #include "ioda/distribution/Accumulator.h"
 #include "ioda/distribution/DistributionFactory.h"
 #include "ioda/distribution/DistributionUtils.h"
+#include "ioda/distribution/NonoverlappingDistribution.h"
 #include "ioda/distribution/PairOfDistributions.h"
+#include "ioda/distribution/RebalancedDistribution.h"
+#include "ioda/distribution/ReductionBatch.h"
 #include "ioda/Engines/EngineUtils.h"
 #include "ioda/Engines/HH.h"
+#include "ioda/Engines/ObsStore.h"
 #include "ioda/Exception.h"
 #include "ioda/Io/IoPool.h"
+#include "ioda/Io/IoPoolUtils.h"
 #include "ioda/io/ObsFrameRead.h"
 #include "ioda/Variables/Variable.h"
 
@@ -61,6 +73,83 @@ bool extractChannelSuffixIfPresent(const std::string &name,
     return false;
 }
 
+// Append the values of a variable at locations \p locs to \p buffer. The values at each location
+// occupy \p valuesPerLoc consecutive elements of \p values.
+template <typename T>
+void packLocations(const std::vector<T> & values, const std::vector<std::size_t> & locs,
+                   std::size_t valuesPerLoc, std::vector<char> & buffer) {
+    const std::size_t bytesPerLoc = valuesPerLoc * sizeof(T);
+    std::size_t offset = buffer.size();
+    buffer.resize(offset + locs.size() * bytesPerLoc);
+    for (std::size_t loc : locs) {
+        std::memcpy(buffer.data() + offset, values.data() + loc * valuesPerLoc, bytesPerLoc);
+        offset += bytesPerLoc;
+    }
+}
+
+void packLocations(const std::vector<std::string> & values, const std::vector<std::size_t> & locs,
+                   std::size_t valuesPerLoc, std::vector<char> & buffer) {
+    for (std::size_t loc : locs) {
+        for (std::size_t i = loc * valuesPerLoc; i < (loc + 1) * valuesPerLoc; ++i) {
+            const std::size_t length = values[i].size();
+            const char * lengthBytes = reinterpret_cast<const char *>(&length);
+            buffer.insert(buffer.end(), lengthBytes, lengthBytes + sizeof(length));
+            buffer.insert(buffer.end(), values[i].begin(), values[i].end());
+        }
+    }
+}
+
+// Extract \p numValues values packed by packLocations() from \p buffer, starting at \p offset,
+// and advance \p offset past them.
+template <typename T>
+void unpackLocations(const std::vector<char> & buffer, std::size_t & offset,
+                     std::size_t numValues, T * values) {
+    const std::size_t numBytes = numValues * sizeof(T);
+    ASSERT(offset + numBytes <= buffer.size());
+    std::memcpy(values, buffer.data() + offset, numBytes);
+    offset += numBytes;
+}
+
+void unpackLocations(const std::vector<char> & buffer, std::size_t & offset,
+                     std::size_t numValues, std::string * values) {
+    for (std::size_t i = 0; i < numValues; ++i) {
+        std::size_t length;
+        unpackLocations(buffer, offset, 1, &length);
+        ASSERT(offset + length <= buffer.size());
+        values[i].assign(buffer.data() + offset, length);
+        offset += length;
+    }
+}
+
+// Return the number of values of \p var at each location (the product of all of its dimensions
+// but the first one).
+std::size_t valuesPerLocation(const Variable & var) {
+    const std::vector<Dimensions_t> dims = var.getDimensions().dimsCur;
+    return static_cast<std::size_t>(std::accumulate(dims.begin() + 1, dims.end(),
+                                                    static_cast<Dimensions_t>(1),
+                                                    std::multiplies<Dimensions_t>()));
+}
+
+// Return true if \p name matches one of the glob \p patterns.
+bool matchesAnyPattern(const std::string & name, const std::vector<std::string> & patterns) {
+    for (const std::string & pattern : patterns)
+        if (fnmatch(pattern.c_str(), name.c_str(), 0) == 0)
+            return true;
+    return false;
+}
+
+// Return the options of the ObsStore groups holding the data of an ObsSpace with the top-level
+// parameters \p params.
+Engines::ObsStore::StorageOptions storageOptions(const ObsTopLevelParameters & params) {
+    Engines::ObsStore::StorageOptions options;
+    if (params.memoryMappedStorage.value() != boost::none) {
+        const ObsStorageParameters & storageParams = *params.memoryMappedStorage.value();
+        options.scratchDirectory = storageParams.scratchDirectory;
+        options.mappedThreshold = storageParams.mappedThreshold;
+    }
+    return options;
+}
+
 }  // namespace
 
 // ----------------------------- public functions ------------------------------
@@ -117,7 +206,8 @@ ObsSpace::ObsSpace(const Parameters_ & params, const eckit::mpi::Comm & comm,
                      : oops::ObsSpaceBase(params, comm, bgn, end),
                        winbgn_(bgn), winend_(end), commMPI_(comm),
                        gnlocs_(0), nrecs_(0), obsvars_(),
-                       obs_group_(), obs_params_(params, bgn, end, comm, timeComm)
+                       obs_group_(), obs_params_(params, bgn, end, comm, timeComm),
+                       full_save_needed_(true)
 {
     // Read the obs space name
     obsname_ = obs_params_.top_level_.obsSpaceName;
@@ -222,28 +312,589 @@ ObsSpace::ObsSpace(const Parameters_ & params, const eckit::mpi::Comm & comm,
       << (globalNumLocsOutsideTimeWindow() + globalNumLocs())
       << std::endl;
 
+    if (obs_params_.top_level_.logMemoryUsage)
+        printMemoryReport(oops::Log::info());
+
     oops::Log::trace() << "ObsSpace::ObsSpace constructed name = " << obsname() << std::endl;
 }
 
+// -----------------------------------------------------------------------------
+ObsSpace::~ObsSpace() {
+    // Destructors must not throw, so only report a failure to complete the output.
+    try {
+        finalizePendingSave();
+    } catch (const std::exception & e) {
+        oops::Log::error() << "ERROR: " << obsname()
+                           << ": unable to complete the asynchronous save: " << e.what()
+                           << std::endl;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void ObsSpace::finalizePendingSave() {
+    if (pending_save_.valid()) {
+        // Wait for the background thread, then release its io pool and communicator
+        // before rethrowing any error raised while writing the file.
+        std::shared_future<void> pendingSave = pending_save_;
+        pending_save_ = std::shared_future<void>();
+        pendingSave.wait();
+        pending_io_pool_.reset();
+        eckit::mpi::deleteComm(save_comm_name_.c_str());
+        try {
+            pendingSave.get();
+        } catch (...) {
+            // The modified variables were not written.
+            full_save_needed_ = true;
+            throw;
+        }
+    }
+    if (pending_io_pool_ != nullptr) {
+        pending_io_pool_->finalize();
+        pending_io_pool_.reset();
+    }
+}
+
 // -----------------------------------------------------------------------------
 void ObsSpace::save() {
+    if ((obs_params_.top_level_.obsDataOut.value() != boost::none) &&
+        obs_params_.top_level_.obsDataOut.value()->asynchronousSave) {
+        saveAsync();
+    } else {
+        saveInForeground();
+    }
+}
+
+// -----------------------------------------------------------------------------
+SaveHandle ObsSpace::saveAsync() {
+    if (obs_params_.top_level_.obsDataOut.value() == boost::none) {
+        saveInForeground();
+        return SaveHandle();
+    }
+    // The library configuration is the same on all tasks, so they all take the same branch.
+    if (!canSaveInBackground()) {
+        oops::Log::info() << obsname() << ": asynchronous save requested, but the MPI library "
+            << "does not provide MPI_THREAD_MULTIPLE or the HDF5 library is not thread safe; "
+            << "falling back to saving in the foreground" << std::endl;
+        saveInForeground();
+        return SaveHandle();
+    }
+
+    if (obs_params_.top_level_.logMemoryUsage)
+        printMemoryReport(oops::Log::info());
+
+    // Complete an earlier save before starting a new one.
+    finalizePendingSave();
+
+    std::vector<std::string> modifiedVars;
+    const bool incremental = collectModifiedVars(modifiedVars);
+    if (incremental && modifiedVars.empty()) {
+        oops::Log::info() << obsname() << ": no variables modified since the previous save"
+                          << std::endl;
+        return SaveHandle();
+    }
+    // The names of the modified variables have been taken out of modified_vars_, so if
+    // this save fails to start the next one must rewrite the whole file. A failure of the
+    // background thread is handled by finalizePendingSave().
+    full_save_needed_ = true;
+
+    // Copy the variables into a staging group so that the obs space can be modified
+    // while the file is written.
+    std::size_t outputNlocs;
+    const Group staging = outputGroup(true, outputNlocs);
+
+    // The background thread communicates on its own copy of the obs space communicator so
+    // that its messages cannot be mixed up with those sent by the main thread in the
+    // meantime. Creating the communicator and the io pool is collective and updates the
+    // eckit communicator registry, which is not thread safe, so do it here.
+    static int saveCount = 0;
+    save_comm_name_ = obsname() + "_save_" + std::to_string(++saveCount);
+    const eckit::mpi::Comm & saveComm = this->comm().split(0, save_comm_name_.c_str());
+    pending_io_pool_.reset(new IoPool(obs_params_.top_level_.ioPool,
+        obs_params_.top_level_.obsDataOut.value()->engine.value().engineParameters,
+        saveComm, obs_params_.timeComm(),
+        obs_params_.windowStart(), obs_params_.windowEnd(), outputNlocs));
+
+    IoPool * obsPool = pending_io_pool_.get();
+    pending_save_ = std::async(std::launch::async,
+                               [obsPool, staging, &saveComm, incremental, modifiedVars]() {
+        if (incremental) {
+            obsPool->update(staging, modifiedVars);
+        } else {
+            obsPool->save(staging);
+        }
+        // Wait for all processes to finish the save call so that we know the file
+        // is complete and closed.
+        saveComm.barrier();
+        obsPool->finalize();
+    }).share();
+    full_save_needed_ = false;
+    oops::Log::info() << obsname() << ": " << (incremental ? "update" : "save")
+                      << " database (in the background) to " << *obsPool << std::endl;
+    return SaveHandle(pending_save_);
+}
+
+// -----------------------------------------------------------------------------
+void ObsSpace::saveInForeground() {
+    if (obs_params_.top_level_.logMemoryUsage)
+        printMemoryReport(oops::Log::info());
+
     if (obs_params_.top_level_.obsDataOut.value() != boost::none) {
+        // Complete an earlier asynchronous save before starting a new one.
+        finalizePendingSave();
+
+        // In incremental mode, only the variables modified since the previous save are
+        // written to its output file.
+        std::vector<std::string> modifiedVars;
+        const bool incremental = collectModifiedVars(modifiedVars);
+        if (incremental && modifiedVars.empty()) {
+            oops::Log::info() << obsname() << ": no variables modified since the previous save"
+                              << std::endl;
+            return;
+        }
+        const std::string action = incremental ? "update" : "save";
+        // The names of the modified variables have been taken out of modified_vars_, so if
+        // this save fails the next one must rewrite the whole file.
+        full_save_needed_ = true;
+
+        // Select the variables and locations to be written before they are transferred
+        // to the io pool.
+        std::size_t outputNlocs;
+        const Group output = outputGroup(false, outputNlocs);
+
         // Write the output file
-        IoPool obsPool(obs_params_.top_level_.ioPool,
+        std::unique_ptr<IoPool> obsPool(new IoPool(obs_params_.top_level_.ioPool,
             obs_params_.top_level_.obsDataOut.value()->engine.value().engineParameters,
             obs_params_.comm(), obs_params_.timeComm() ,
-            obs_params_.windowStart(), obs_params_.windowEnd(), nlocs());
-        obsPool.save(obs_group_);
-        // Wait for all processes to finish the save call so that we know the file
-        // is complete and closed.
-        this->comm().barrier();
-        oops::Log::info() << obsname() << ": save database to " << obsPool << std::endl;
-        obsPool.finalize();
+            obs_params_.windowStart(), obs_params_.windowEnd(), outputNlocs));
+        if (incremental) {
+            obsPool->update(output, modifiedVars);
+        } else {
+            obsPool->save(output);
+        }
+        full_save_needed_ = false;
+        if (obsPool->is_asynchronous()) {
+            // The ranks outside the io pool carry on while their data are transferred to
+            // the io pool ranks, which write the file. The io pool is finalized by the
+            // next save or when the ObsSpace is destroyed.
+            oops::Log::info() << obsname() << ": " << action << " database (asynchronously) to "
+                              << *obsPool << std::endl;
+            pending_io_pool_ = std::move(obsPool);
+        } else {
+            // Wait for all processes to finish the save call so that we know the file
+            // is complete and closed.
+            this->comm().barrier();
+            oops::Log::info() << obsname() << ": " << action << " database to " << *obsPool
+                              << std::endl;
+            obsPool->finalize();
+        }
     } else {
         oops::Log::info() << obsname() << " :  no output" << std::endl;
     }
 }
 
+// -----------------------------------------------------------------------------
+bool ObsSpace::collectModifiedVars(std::vector<std::string> & varNames) {
+    {
+        std::lock_guard<std::mutex> lock(modified_vars_mutex_);
+        varNames.assign(modified_vars_.begin(), modified_vars_.end());
+        modified_vars_.clear();
+    }
+    // The locations dropped from the output depend on the QC flags, which may have changed.
+    const ObsDataOutParameters & outParams = *obs_params_.top_level_.obsDataOut.value();
+    if (!outParams.incrementalSave || !outParams.dropQcFlags.value().empty())
+        return false;
+    // Only the HDF5 writer can reopen an existing file.
+    const std::string & engineType =
+        outParams.engine.value().engineParameters.value().type.value();
+    if (engineType != "H5File") {
+        oops::Log::info() << obsname() << ": the " << engineType << " writer cannot update "
+                          << "an existing file, writing the whole file instead" << std::endl;
+        return false;
+    }
+
+    // The io pool transfers need the same variables on all tasks.
+    int fullSave = full_save_needed_ ? 1 : 0;
+    commMPI_.allReduceInPlace(fullSave, eckit::mpi::max());
+    if (fullSave != 0)
+        return false;
+    oops::mpi::allGatherv(commMPI_, varNames);
+    std::sort(varNames.begin(), varNames.end());
+    varNames.erase(std::unique(varNames.begin(), varNames.end()), varNames.end());
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+Group ObsSpace::outputGroup(const bool alwaysCopy, std::size_t & outputNlocs) const {
+    const ObsDataOutParameters & outParams = *obs_params_.top_level_.obsDataOut.value();
+    const std::vector<std::string> & includeVars = outParams.includeVariables;
+    const std::vector<std::string> & excludeVars = outParams.excludeVariables;
+    const std::vector<int> & dropQcFlags = outParams.dropQcFlags;
+    const Engines::ObsStore::StorageOptions stagingOptions = storageOptions(obs_params_.top_level_);
+    outputNlocs = this->nlocs();
+
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    if (includeVars.empty() && excludeVars.empty() && dropQcFlags.empty()) {
+        if (!alwaysCopy)
+            return obs_group_;
+        Group staging = Engines::ObsStore::createRootGroup(stagingOptions);
+        copyGroup(obs_group_, staging);
+        return staging;
+    }
+
+    // Copy the selected variables.
+    VarUtils::Vec_Named_Variable varList, dimVarList;
+    VarUtils::VarDimMap dimsAttachedToVars;
+    Dimensions_t maxVarSize0;
+    VarUtils::collectVarDimInfo(obs_group_, varList, dimVarList, dimsAttachedToVars,
+                                maxVarSize0);
+    std::vector<std::string> selectedVars;
+    for (const auto & namedVar : varList) {
+        if ((includeVars.empty() || matchesAnyPattern(namedVar.name, includeVars)) &&
+            !matchesAnyPattern(namedVar.name, excludeVars))
+            selectedVars.push_back(namedVar.name);
+    }
+    Group staging = Engines::ObsStore::createRootGroup(stagingOptions);
+    copyGroup(obs_group_, staging, selectedVars);
+    if (dropQcFlags.empty())
+        return staging;
+
+    // Keep the locations where at least one of the QC flags (of any variable and channel)
+    // is not among those to be dropped.
+    const std::string nlocsName = dim_info_.get_dim_name(ObsDimensionId::Nlocs);
+    const std::string qcPrefix = outParams.qcGroup.value() + "/";
+    const std::set<int> dropFlags(dropQcFlags.begin(), dropQcFlags.end());
+    std::vector<bool> keepLoc(outputNlocs, false);
+    bool foundQcFlags = false;
+    for (const auto & namedVar : varList) {
+        const VarUtils::Vec_Named_Variable & dims = dimsAttachedToVars.at(namedVar);
+        if (namedVar.name.compare(0, qcPrefix.size(), qcPrefix) != 0 || dims.empty() ||
+            dims[0].name != nlocsName || !namedVar.var.isA<int>())
+            continue;
+        foundQcFlags = true;
+        const std::size_t valuesPerLoc = valuesPerLocation(namedVar.var);
+        std::vector<int> flags;
+        namedVar.var.read<int>(flags);
+        for (std::size_t loc = 0; loc < outputNlocs; ++loc)
+            for (std::size_t i = loc * valuesPerLoc; i < (loc + 1) * valuesPerLoc; ++i)
+                if (dropFlags.count(flags[i]) == 0)
+                    keepLoc[loc] = true;
+    }
+    if (!foundQcFlags)
+        return staging;
+    std::vector<std::size_t> keptLocs;
+    for (std::size_t loc = 0; loc < outputNlocs; ++loc)
+        if (keepLoc[loc])
+            keptLocs.push_back(loc);
+
+    // As in rebalance(), move the values at the kept locations to the front of each variable
+    // indexed by nlocs along its first dimension, and then shrink the nlocs dimension.
+    VarUtils::Vec_Named_Variable stagingVarList, stagingDimVarList;
+    VarUtils::VarDimMap stagingDimsAttachedToVars;
+    VarUtils::collectVarDimInfo(staging, stagingVarList, stagingDimVarList,
+                                stagingDimsAttachedToVars, maxVarSize0);
+    Variable nlocsVar = staging.vars.open(nlocsName);
+    VarUtils::Vec_Named_Variable nlocsVarList(1, Named_Variable(nlocsName, nlocsVar));
+    for (const auto & namedVar : stagingVarList) {
+        const VarUtils::Vec_Named_Variable & dims = stagingDimsAttachedToVars.at(namedVar);
+        if (!dims.empty() && dims[0].name == nlocsName)
+            nlocsVarList.push_back(namedVar);
+    }
+    for (const auto & namedVar : nlocsVarList) {
+        Variable var = namedVar.var;
+        const std::size_t valuesPerLoc = valuesPerLocation(var);
+        VarUtils::forAnySupportedVariableType(
+              var,
+              [&](auto typeDiscriminator) {
+                  typedef decltype(typeDiscriminator) T;
+                  std::vector<T> values;
+                  var.read<T>(values);
+                  for (std::size_t i = 0; i < keptLocs.size(); ++i)
+                      if (keptLocs[i] != i)
+                          std::move(values.begin() + keptLocs[i] * valuesPerLoc,
+                                    values.begin() + (keptLocs[i] + 1) * valuesPerLoc,
+                                    values.begin() + i * valuesPerLoc);
+                  var.write<T>(values);
+              },
+              VarUtils::ThrowIfVariableIsOfUnsupportedType(namedVar.name));
+    }
+    ObsGroup(staging).resize({ std::pair<Variable, Dimensions_t>(
+        nlocsVar, static_cast<Dimensions_t>(keptLocs.size())) });
+    outputNlocs = keptLocs.size();
+    return staging;
+}
+
+// -----------------------------------------------------------------------------
+void ObsSpace::printMemoryReport(std::ostream & os) const {
+    MemoryReport localReport;
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        localReport = obs_group_.getMemoryReport();
+    }
+
+    // Different tasks may hold different variables (e.g. after a filter created a variable
+    // on a subset of tasks), so report on the union of the variable names.
+    std::vector<std::string> varNames;
+    for (const auto & entry : localReport)
+        varNames.push_back(entry.first);
+    oops::mpi::allGatherv(commMPI_, varNames);
+    std::sort(varNames.begin(), varNames.end());
+    varNames.erase(std::unique(varNames.begin(), varNames.end()), varNames.end());
+
+    MemoryReport report;
+    for (const std::string & varName : varNames) {
+        const auto it = localReport.find(varName);
+        report[varName] = (it != localReport.end()) ? it->second : MemoryUsage();
+    }
+    const std::map<std::string, MemoryUsage> groupReport = aggregateByGroup(report);
+
+    // Reduce the totals of all variables and groups and the components of the group totals
+    // with one call per operation.
+    std::vector<std::size_t> totals;
+    totals.reserve(report.size() + groupReport.size());
+    for (const auto & entry : report)
+        totals.push_back(entry.second.total());
+    for (const auto & entry : groupReport)
+        totals.push_back(entry.second.total());
+    std::vector<std::size_t> minTotals(totals), maxTotals(totals), sumTotals(totals);
+    std::vector<std::size_t> sumComponents;
+    sumComponents.reserve(5 * groupReport.size());
+    for (const auto & entry : groupReport) {
+        sumComponents.push_back(entry.second.dataBytes);
+        sumComponents.push_back(entry.second.slackBytes);
+        sumComponents.push_back(entry.second.stringHeapBytes);
+        sumComponents.push_back(entry.second.attributeBytes);
+        sumComponents.push_back(entry.second.mappedBytes);
+    }
+    if (!totals.empty()) {
+        commMPI_.allReduceInPlace(minTotals.begin(), minTotals.end(), eckit::mpi::min());
+        commMPI_.allReduceInPlace(maxTotals.begin(), maxTotals.end(), eckit::mpi::max());
+        commMPI_.allReduceInPlace(sumTotals.begin(), sumTotals.end(), eckit::mpi::sum());
+        commMPI_.allReduceInPlace(sumComponents.begin(), sumComponents.end(),
+                                  eckit::mpi::sum());
+    }
+
+    if (commMPI_.rank() != 0)
+        return;
+
+    const auto printRow = [&os](const std::string & name, std::size_t minBytes,
+                                std::size_t maxBytes, std::size_t sumBytes) {
+        os << "  " << std::left << std::setw(48) << name << std::right
+           << std::setw(14) << minBytes << std::setw(14) << maxBytes
+           << std::setw(16) << sumBytes << std::endl;
+    };
+
+    os << obsname() << ": memory used by variables (bytes over "
+       << commMPI_.size() << " tasks)" << std::endl;
+    os << "  " << std::left << std::setw(48) << "variable" << std::right
+       << std::setw(14) << "min" << std::setw(14) << "max" << std::setw(16) << "sum"
+       << std::endl;
+    std::size_t itotal = 0;
+    for (const auto & entry : report) {
+        printRow(entry.first, minTotals[itotal], maxTotals[itotal], sumTotals[itotal]);
+        ++itotal;
+    }
+
+    os << obsname() << ": memory used by groups (bytes over "
+       << commMPI_.size() << " tasks)" << std::endl;
+    os << "  " << std::left << std::setw(48) << "group" << std::right
+       << std::setw(14) << "min" << std::setw(14) << "max" << std::setw(16) << "sum"
+       << "  (data, slack, string heap, attributes, mapped)" << std::endl;
+    std::size_t icomponent = 0;
+    for (const auto & entry : groupReport) {
+        const std::string groupName = entry.first.empty() ? "/" : entry.first;
+        os << "  " << std::left << std::setw(48) << groupName << std::right
+           << std::setw(14) << minTotals[itotal] << std::setw(14) << maxTotals[itotal]
+           << std::setw(16) << sumTotals[itotal] << "  (" << sumComponents[icomponent] << ", "
+           << sumComponents[icomponent + 1] << ", " << sumComponents[icomponent + 2] << ", "
+           << sumComponents[icomponent + 3] << ", " << sumComponents[icomponent + 4] << ")"
+           << std::endl;
+        ++itotal;
+        icomponent += 5;
+    }
+}
+
+// -----------------------------------------------------------------------------
+std::shared_ptr<const Distribution> ObsSpace::rebalance(const std::vector<bool> & activeLocs) {
+    const std::size_t nLocs = this->nlocs();
+    ASSERT(activeLocs.size() == nLocs);
+    if (dynamic_cast<const NonoverlappingDistribution *>(dist_.get()) == nullptr)
+        throw eckit::NotImplemented("ObsSpace::rebalance: the " + dist_->name() +
+                                    " distribution is not supported", Here());
+    const std::size_t nranks = commMPI_.size();
+    const int myRank = commMPI_.rank();
+
+    // Choose the destination of each record held on this task.
+    std::vector<std::size_t> recordWeights;
+    recordWeights.reserve(recidx_.size());
+    for (const auto & record : recidx_) {
+        std::size_t numActiveLocs = 0;
+        for (std::size_t loc : record.second)
+            if (activeLocs[loc])
+                ++numActiveLocs;
+        recordWeights.push_back(numActiveLocs);
+    }
+    const std::vector<int> recordDestinations = rebalanceRecords(commMPI_, recordWeights);
+
+    // Split the locations held on this task into those staying here and those sent elsewhere.
+    std::vector<std::size_t> keptLocs;
+    std::vector<std::vector<std::size_t>> sentLocs(nranks);
+    {
+        std::vector<int> locDestinations(nLocs, myRank);
+        std::size_t irec = 0;
+        for (const auto & record : recidx_) {
+            for (std::size_t loc : record.second)
+                locDestinations[loc] = recordDestinations[irec];
+            ++irec;
+        }
+        for (std::size_t loc = 0; loc < nLocs; ++loc) {
+            if (locDestinations[loc] == myRank)
+                keptLocs.push_back(loc);
+            else
+                sentLocs[locDestinations[loc]].push_back(loc);
+        }
+    }
+    std::size_t globalNumMovedLocs = nLocs - keptLocs.size();
+    commMPI_.allReduceInPlace(globalNumMovedLocs, eckit::mpi::sum());
+    oops::Log::info() << obsname() << ": rebalancing moves " << globalNumMovedLocs
+                      << " locations" << std::endl;
+    if (globalNumMovedLocs == 0)
+        return dist_;
+
+    // Variables to be redistributed: all those indexed by nlocs along their first dimension.
+    // Sort them by name so that all tasks pack and unpack them in the same order.
+    const std::string nlocsName = dim_info_.get_dim_name(ObsDimensionId::Nlocs);
+    VarUtils::Vec_Named_Variable varList;
+    {
+        VarUtils::Vec_Named_Variable allVarList, dimVarList;
+        VarUtils::VarDimMap dimsAttachedToVars;
+        Dimensions_t maxVarSize0;
+        VarUtils::collectVarDimInfo(obs_group_, allVarList, dimVarList, dimsAttachedToVars,
+                                    maxVarSize0);
+        for (const auto & namedVar : allVarList) {
+            const VarUtils::Vec_Named_Variable & dims = dimsAttachedToVars.at(namedVar);
+            if (!dims.empty() && dims[0].name == nlocsName)
+                varList.push_back(namedVar);
+        }
+        std::sort(varList.begin(), varList.end());
+    }
+    // Pack the number of locations sent to each task, their global indices, record numbers and
+    // the values of all variables into a single buffer per destination. At the same time,
+    // move the values at the locations staying on this task to the front of each variable.
+    std::vector<std::vector<char>> sendBuffers(nranks);
+    for (std::size_t rank = 0; rank < nranks; ++rank) {
+        const std::vector<std::size_t> numSentLocs(1, sentLocs[rank].size());
+        packLocations(numSentLocs, {0}, 1, sendBuffers[rank]);
+        packLocations(indx_, sentLocs[rank], 1, sendBuffers[rank]);
+        packLocations(recnums_, sentLocs[rank], 1, sendBuffers[rank]);
+    }
+    for (const auto & namedVar : varList) {
+        Variable var = namedVar.var;
+        const std::size_t valuesPerLoc = valuesPerLocation(var);
+        VarUtils::forAnySupportedVariableType(
+              var,
+              [&](auto typeDiscriminator) {
+                  typedef decltype(typeDiscriminator) T;
+                  std::vector<T> values;
+                  var.read<T>(values);
+                  for (std::size_t rank = 0; rank < nranks; ++rank)
+                      packLocations(values, sentLocs[rank], valuesPerLoc, sendBuffers[rank]);
+                  for (std::size_t i = 0; i < keptLocs.size(); ++i)
+                      if (keptLocs[i] != i)
+                          std::move(values.begin() + keptLocs[i] * valuesPerLoc,
+                                    values.begin() + (keptLocs[i] + 1) * valuesPerLoc,
+                                    values.begin() + i * valuesPerLoc);
+                  var.write<T>(values);
+              },
+              VarUtils::ThrowIfVariableIsOfUnsupportedType(namedVar.name));
+    }
+
+    // Exchange the data.
+    std::vector<std::vector<char>> recvBuffers(nranks);
+    commMPI_.allToAll(sendBuffers, recvBuffers);
+    sendBuffers.clear();
+
+    // Unpack the global indices and record numbers of the received locations, which are placed
+    // after the locations staying on this task.
+    std::vector<std::size_t> offsets(nranks, 0);
+    std::vector<std::size_t> numRecvLocs(nranks);
+    std::size_t newNlocs = keptLocs.size();
+    for (std::size_t rank = 0; rank < nranks; ++rank) {
+        unpackLocations(recvBuffers[rank], offsets[rank], 1, &numRecvLocs[rank]);
+        newNlocs += numRecvLocs[rank];
+    }
+    std::vector<std::size_t> newIndx(newNlocs);
+    std::vector<std::size_t> newRecnums(newNlocs);
+    for (std::size_t i = 0; i < keptLocs.size(); ++i) {
+        newIndx[i] = indx_[keptLocs[i]];
+        newRecnums[i] = recnums_[keptLocs[i]];
+    }
+    for (std::size_t rank = 0, loc = keptLocs.size(); rank < nranks; ++rank) {
+        unpackLocations(recvBuffers[rank], offsets[rank], numRecvLocs[rank], &newIndx[loc]);
+        unpackLocations(recvBuffers[rank], offsets[rank], numRecvLocs[rank], &newRecnums[loc]);
+        loc += numRecvLocs[rank];
+    }
+
+    // As after reading, store locations in the order of increasing global index.
+    std::vector<std::size_t> order(newNlocs);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&newIndx](std::size_t a, std::size_t b)
+              { return newIndx[a] < newIndx[b]; });
+
+    this->resizeNlocs(newNlocs, false);
+    for (const auto & namedVar : varList) {
+        Variable var = namedVar.var;
+        const std::size_t valuesPerLoc = valuesPerLocation(var);
+        VarUtils::forAnySupportedVariableType(
+              var,
+              [&](auto typeDiscriminator) {
+                  typedef decltype(typeDiscriminator) T;
+                  std::vector<T> values;
+                  var.read<T>(values);
+                  for (std::size_t rank = 0, loc = keptLocs.size(); rank < nranks; ++rank) {
+                      unpackLocations(recvBuffers[rank], offsets[rank],
+                                      numRecvLocs[rank] * valuesPerLoc,
+                                      values.data() + loc * valuesPerLoc);
+                      loc += numRecvLocs[rank];
+                  }
+                  std::vector<T> sortedValues(values.size());
+                  for (std::size_t i = 0; i < newNlocs; ++i)
+                      std::move(values.begin() + order[i] * valuesPerLoc,
+                                values.begin() + (order[i] + 1) * valuesPerLoc,
+                                sortedValues.begin() + i * valuesPerLoc);
+                  var.write<T>(sortedValues);
+              },
+              VarUtils::ThrowIfVariableIsOfUnsupportedType(namedVar.name));
+    }
+    recvBuffers.clear();
+
+    indx_.resize(newNlocs);
+    recnums_.resize(newNlocs);
+    for (std::size_t i = 0; i < newNlocs; ++i) {
+        indx_[i] = newIndx[order[i]];
+        recnums_[i] = newRecnums[order[i]];
+    }
+    dim_info_.set_dim_size(ObsDimensionId::Nlocs, newNlocs);
+    known_fe_selections_.clear();
+    known_be_selections_.clear();
+    full_save_needed_ = true;
+
+    recidx_.clear();
+    if (recidx_is_sorted_)
+        buildSortedObsGroups();
+    else
+        buildRecIdxUnsorted();
+    nrecs_ = recidx_.size();
+
+    // Describe the new assignment of records to tasks by a new distribution.
+    std::shared_ptr<Distribution> newDist =
+        std::make_shared<RebalancedDistribution>(commMPI_, recidx_all_recnums());
+    for (std::size_t loc = 0; loc < newNlocs; ++loc)
+        newDist->assignRecord(recnums_[loc], indx_[loc], eckit::geometry::Point2());
+    newDist->computePatchLocs();
+    dist_ = newDist;
+    return dist_;
+}
+
 // -----------------------------------------------------------------------------
 std::size_t ObsSpace::nvars() const {
     // Nvars is the number of variables in the ObsValue group. By querying
@@ -292,6 +943,13 @@ std::string ObsSpace::obs_sort_order() const {
  *          otherwise "false" is returned.
  */
 bool ObsSpace::has(const std::string & group, const std::string & name, bool skipDerived) const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    return hasVar(group, name, skipDerived);
+}
+
+// -----------------------------------------------------------------------------
+bool ObsSpace::hasVar(const std::string & group, const std::string & name,
+                      bool skipDerived) const {
     // For backward compatibility, recognize and handle appropriately variable names with
     // channel suffixes.
     std::string nameToUse;
@@ -304,6 +962,8 @@ bool ObsSpace::has(const std::string & group, const std::string & name, bool ski
 // -----------------------------------------------------------------------------
 ObsDtype ObsSpace::dtype(const std::string & group, const std::string & name,
                          bool skipDerived) const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+
     // For backward compatibility, recognize and handle appropriately variable names with
     // channel suffixes.
     std::string nameToUse;
@@ -316,7 +976,7 @@ ObsDtype ObsSpace::dtype(const std::string & group, const std::string & name,
 
     // Set the type to None if there is no type from the backend
     ObsDtype VarType = ObsDtype::None;
-    if (has(groupToUse, nameToUse, skipDerived)) {
+    if (hasVar(groupToUse, nameToUse, skipDerived)) {
         const std::string varNameToUse = fullVarName(groupToUse, nameToUse);
         Variable var = obs_group_.vars.open(varNameToUse);
         VarUtils::switchOnSupportedVariableType(
@@ -395,9 +1055,8 @@ void ObsSpace::get_db(const std::string & group, const std::string & name,
                      std::vector<util::DateTime> & vdata,
                      const std::vector<int> & chanSelect, bool skipDerived) const {
     std::vector<int64_t> timeOffsets;
-    loadVar<int64_t>(group, name, chanSelect, timeOffsets, skipDerived);
-    Variable dtVar = obs_group_.vars.open(group + std::string("/") + name);
-    util::DateTime epochDt = getEpochAsDtime(dtVar);
+    util::DateTime epochDt;
+    get_time_offsets(group, name, timeOffsets, epochDt, chanSelect, skipDerived);
     vdata = convertEpochDtToDtime(epochDt, timeOffsets);
 }
 
@@ -413,6 +1072,37 @@ void ObsSpace::get_db(const std::string & group, const std::string & name,
     vdata.assign(charData.begin(), charData.end());
 }
 
+void ObsSpace::get_time_offsets(const std::string & group, const std::string & name,
+                                std::vector<int64_t> & offsets, util::DateTime & epoch,
+                                const std::vector<int> & chanSelect, bool skipDerived) const {
+    loadVar<int64_t>(group, name, chanSelect, offsets, skipDerived);
+    epoch = this->epoch(group, name, skipDerived);
+}
+
+// -----------------------------------------------------------------------------
+const util::DateTime & ObsSpace::epoch(const std::string & group, const std::string & name,
+                                       bool skipDerived) const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    // Use the same variable as loadVar(), preferring the one from the Derived* group.
+    std::string groupToUse = "Derived" + group;
+    if (skipDerived || !obs_group_.vars.exists(fullVarName(groupToUse, name)))
+      groupToUse = group;
+    return cachedEpoch(fullVarName(groupToUse, name));
+}
+
+// -----------------------------------------------------------------------------
+std::vector<bool> ObsSpace::insideTimeWindow(const std::vector<int64_t> & offsets,
+                                             const util::DateTime & epoch) const {
+    const int64_t missingInt64 = util::missingValue(missingInt64);
+    const int64_t startOffset = windowStartOffset(epoch);
+    const int64_t endOffset = windowEndOffset(epoch);
+    std::vector<bool> inside(offsets.size());
+    for (std::size_t i = 0; i < offsets.size(); ++i)
+      inside[i] = offsets[i] != missingInt64 && offsets[i] > startOffset &&
+                  offsets[i] <= endOffset;
+    return inside;
+}
+
 // -----------------------------------------------------------------------------
 void ObsSpace::put_db(const std::string & group, const std::string & name,
                      const std::vector<int> & vdata,
@@ -454,11 +1144,15 @@ void ObsSpace::put_db(const std::string & group, const std::string & name,
     // of through the openCreateVar call in saveVar because of the need to get the
     // epoch value for converting the data before calling saveVar. Use the epoch DateTime
     // parameter for the units if creating a new variable.
-    Variable dtVar;
-    openCreateEpochDtimeVar(group, name, obs_params_.top_level_.epochDateTime,
-                            dtVar, obs_group_.vars);
-    util::DateTime epochDtime = getEpochAsDtime(dtVar);
-    std::vector<int64_t> timeOffsets = convertDtimeToTimeOffsets(epochDtime, vdata);
+    std::vector<int64_t> timeOffsets;
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+        Variable dtVar;
+        openCreateEpochDtimeVar(group, name, obs_params_.top_level_.epochDateTime,
+                                dtVar, obs_group_.vars);
+        const util::DateTime & epochDtime = cachedEpoch(fullVarName(group, name));
+        timeOffsets = convertDtimeToTimeOffsets(epochDtime, vdata);
+    }
     saveVar(group, name, timeOffsets, dimList);
 }
 
@@ -496,30 +1190,40 @@ std::size_t ObsSpace::recidx_recnum(const RecIdxIter & irec) const {
 
 // -----------------------------------------------------------------------------
 const std::vector<std::size_t> & ObsSpace::recidx_vector(const RecIdxIter & irec) const {
-  return irec->second;
+  return recidx_.locationsVector(irec - recidx_.begin());
 }
 
 // -----------------------------------------------------------------------------
 const std::vector<std::size_t> & ObsSpace::recidx_vector(const std::size_t recNum) const {
+  return recidx_vector(findRecord(recNum, "ObsSpace::recidx_vector"));
+}
+
+// -----------------------------------------------------------------------------
+RecordIndex::Locations ObsSpace::recidx_locations(const RecIdxIter & irec) const {
+  return irec->second;
+}
+
+// -----------------------------------------------------------------------------
+RecordIndex::Locations ObsSpace::recidx_locations(const std::size_t recNum) const {
+  return findRecord(recNum, "ObsSpace::recidx_locations")->second;
+}
+
+// -----------------------------------------------------------------------------
+ObsSpace::RecIdxIter ObsSpace::findRecord(const std::size_t recNum,
+                                          const std::string & caller) const {
   RecIdxIter Irec = recidx_.find(recNum);
   if (Irec == recidx_.end()) {
     std::string ErrMsg =
-      "ObsSpace::recidx_vector: Record number, " + std::to_string(recNum) +
+      caller + ": Record number, " + std::to_string(recNum) +
       ", does not exist in record index map.";
     ABORT(ErrMsg);
   }
-  return Irec->second;
+  return Irec;
 }
 
 // -----------------------------------------------------------------------------
 std::vector<std::size_t> ObsSpace::recidx_all_recnums() const {
-  std::vector<std::size_t> RecNums(nrecs_);
-  std::size_t recnum = 0;
-  for (RecIdxIter Irec = recidx_.begin(); Irec != recidx_.end(); ++Irec) {
-    RecNums[recnum] = Irec->first;
-    recnum++;
-  }
-  return RecNums;
+  return recidx_.recordNumbers();
 }
 
 // ----------------------------- private functions -----------------------------
@@ -582,6 +1286,12 @@ void ObsSpace::createObsGroupFromObsFrame(ObsFrameRead & obsFrame) {
     backendParams.fileName = ioda::Engines::HH::genUniqueName();
     backendParams.allocBytes = 1024*1024*50;
     backendParams.flush = false;
+    if (obs_params_.top_level_.memoryMappedStorage.value() != boost::none) {
+        const ObsStorageParameters & storageParams =
+            *obs_params_.top_level_.memoryMappedStorage.value();
+        backendParams.scratchDirectory = storageParams.scratchDirectory;
+        backendParams.mappedThreshold = storageParams.mappedThreshold;
+    }
     Group backend = constructBackend(backendName, backendParams);
 
     // Create the ObsGroup and attach the backend.
@@ -758,6 +1468,7 @@ void ObsSpace::resizeNlocs(const Dimensions_t nlocsSize, const bool append) {
     }
     obs_group_.resize(
         { std::pair<Variable, Dimensions_t>(nlocsVar, nlocsResize) });
+    full_save_needed_ = true;
 }
 
 // -----------------------------------------------------------------------------
@@ -767,6 +1478,8 @@ void ObsSpace::loadVar(const std::string & group, const std::string & name,
                        const std::vector<int> & chanSelect,
                        std::vector<VarType> & varValues,
                        bool skipDerived) const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+
     // For backward compatibility, recognize and handle appropriately variable names with
     // channel suffixes.
     std::string nameToUse;
@@ -820,6 +1533,12 @@ template<typename VarType>
 void ObsSpace::saveVar(const std::string & group, std::string name,
                       const std::vector<VarType> & varValues,
                       const std::vector<std::string> & dimList) {
+    // Writing to an existing variable only needs shared access to the container, so that
+    // several threads can write to distinct variables at the same time. Creating a variable
+    // changes the container and needs exclusive access.
+    std::shared_lock<std::shared_timed_mutex> sharedLock(mutex_);
+    std::unique_lock<std::shared_timed_mutex> exclusiveLock(mutex_, std::defer_lock);
+
     // For backward compatibility, recognize and handle appropriately variable names with
     // channel suffixes.
 
@@ -836,6 +1555,10 @@ void ObsSpace::saveVar(const std::string & group, std::string name,
     }
 
     const std::string fullName = fullVarName(group, name);
+    if (!obs_group_.vars.exists(fullName)) {
+        sharedLock.unlock();
+        exclusiveLock.lock();
+    }
 
     std::vector<std::string> dimListToUse = dimList;
     if (!obs_group_.vars.exists(fullName) && !channels.empty()) {
@@ -868,6 +1591,9 @@ void ObsSpace::saveVar(const std::string & group, std::string name,
                                 memSelect, obsGroupSelect);
         var.write<VarType>(varValues, memSelect, obsGroupSelect);
     }
+
+    std::lock_guard<std::mutex> lock(modified_vars_mutex_);
+    modified_vars_.insert(fullName);
 }
 
 // -----------------------------------------------------------------------------
@@ -1070,6 +1796,15 @@ void ObsSpace::fillChanNumToIndexMap() {
     }
 }
 
+// -----------------------------------------------------------------------------
+const util::DateTime & ObsSpace::cachedEpoch(const std::string & fullName) const {
+    std::lock_guard<std::mutex> lock(epochs_mutex_);
+    auto it = epochs_.find(fullName);
+    if (it == epochs_.end())
+      it = epochs_.emplace(fullName, getEpochAsDtime(obs_group_.vars.open(fullName))).first;
+    return it->second;
+}
+
 // -----------------------------------------------------------------------------
 void ObsSpace::splitChanSuffix(const std::string & group, const std::string & name,
                                const std::vector<int> & chanSelect, std::string & nameToUse,
@@ -1090,132 +1825,90 @@ void ObsSpace::splitChanSuffix(const std::string & group, const std::string & na
 
 // -----------------------------------------------------------------------------
 void ObsSpace::buildSortedObsGroups() {
-    typedef std::map<std::size_t, std::vector<std::pair<float, std::size_t>>> TmpRecIdxMap;
-    typedef TmpRecIdxMap::iterator TmpRecIdxIter;
-
     const float missingFloat = util::missingValue(missingFloat);
     const util::DateTime missingDateTime = util::missingValue(missingDateTime);
     const MissingSortValueTreatment missingSortValueTreatment =
       obs_params_.top_level_.obsDataIn.value().obsGrouping.value().missingSortValueTreatment;
 
-    // Get the sort variable from the data store, and convert to a vector of floats.
+    // Get the sort variable from the data store and convert it to a vector of unsigned integer
+    // keys whose order matches that of the sort values, so that the locations can be sorted
+    // with a radix sort. Date/times are represented by their integer offsets in seconds from
+    // the epoch, which (unlike floats) are exact and need no conversion to util::DateTime.
     std::size_t nLocs = this->nlocs();
-    std::vector<float> SortValues(nLocs);
+    std::vector<std::uint64_t> sortKeys(nLocs);
     std::vector<bool> sortValueMissing(nLocs, false);
     if (this->obs_sort_var() == "dateTime") {
-        std::vector<util::DateTime> Dates(nLocs);
-        get_db("MetaData", this->obs_sort_var(), Dates);
+        std::vector<int64_t> offsets;
+        util::DateTime epoch;
+        get_time_offsets("MetaData", this->obs_sort_var(), offsets, epoch);
+        const int64_t missingInt64 = util::missingValue(missingInt64);
+        // Missing date/times are sorted as if they were equal to the missing DateTime value.
+        const int64_t missingOffset = (missingDateTime - epoch).toSeconds();
         for (std::size_t iloc = 0; iloc < nLocs; iloc++) {
-            SortValues[iloc] = (Dates[iloc] - Dates[0]).toSeconds();
-            if (Dates[iloc] == missingDateTime)
+            std::int64_t offset = offsets[iloc];
+            if (offset == missingInt64) {
+              offset = missingOffset;
               sortValueMissing[iloc] = true;
+            }
+            // Flip the sign bit to map signed to unsigned order.
+            sortKeys[iloc] = static_cast<std::uint64_t>(offset) ^ (std::uint64_t(1) << 63);
         }
     } else {
+        std::vector<float> SortValues(nLocs);
         get_db(this->obs_sort_group(), this->obs_sort_var(), SortValues);
         for (std::size_t iloc = 0; iloc < nLocs; iloc++) {
+          // -0.0 compares equal to 0.0, so give both the same key.
+          const float value = SortValues[iloc] == 0.0f ? 0.0f : SortValues[iloc];
+          std::uint32_t bits;
+          std::memcpy(&bits, &value, sizeof(bits));
+          // Negative floats are ordered by decreasing magnitude, positive ones by increasing
+          // magnitude.
+          sortKeys[iloc] = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
           if (SortValues[iloc] == missingFloat)
             sortValueMissing[iloc] = true;
         }
     }
-
-    // Construct a temporary structure to do the sorting, then transfer the results
-    // to the data member recidx_.
-    TmpRecIdxMap TmpRecIdx;
-    // Indices of missing sort values for each record number.
-    std::map<std::size_t, std::vector<std::size_t>> TmpRecIdx_missing;
-    // Whether or not each location in a record has a missing sort value.
-    std::map<std::size_t, std::vector<bool>> sortValueMissingInRecord;
-    // Indicates whether a particular record has at least one missing sort value.
-    std::map<std::size_t, bool> recordContainsAtLeastOneMissingSortValue;
-
-    for (size_t iloc = 0; iloc < nLocs; iloc++) {
-        const std::size_t recnum = recnums_[iloc];
-        if (missingSortValueTreatment == MissingSortValueTreatment::SORT) {
-          TmpRecIdx[recnum].push_back(std::make_pair(SortValues[iloc], iloc));
-        } else if (missingSortValueTreatment == MissingSortValueTreatment::NO_SORT) {
-          TmpRecIdx[recnum].push_back(std::make_pair(SortValues[iloc], iloc));
-          if (sortValueMissing[iloc])
-            recordContainsAtLeastOneMissingSortValue[recnum] = true;
-        } else if (missingSortValueTreatment == MissingSortValueTreatment::IGNORE_MISSING) {
-          if (sortValueMissing[iloc]) {
-            TmpRecIdx_missing[recnum].push_back(iloc);
-            sortValueMissingInRecord[recnum].push_back(true);
-          } else {
-            TmpRecIdx[recnum].push_back(std::make_pair(SortValues[iloc], iloc));
-            sortValueMissingInRecord[recnum].push_back(false);
-          }
-        }
+    if (this->obs_sort_order() != "ascending") {
+        // Reverse the order of the keys. Locations with equal sort values remain in
+        // ascending order.
+        for (std::uint64_t & key : sortKeys)
+          key = ~key;
     }
 
-    for (TmpRecIdxIter irec = TmpRecIdx.begin(); irec != TmpRecIdx.end(); ++irec) {
-        // Check if any values of the sort variable in this profile are missing.
-        // If so, do not proceed with the sort.
-        if (missingSortValueTreatment == MissingSortValueTreatment::NO_SORT &&
-            recordContainsAtLeastOneMissingSortValue[irec->first])
-          continue;
-
-        if (this->obs_sort_order() == "ascending") {
-            sort(irec->second.begin(), irec->second.end());
-        } else {
-            // Use a lambda function to access the std::pair greater-than operator to
-            // implement a descending order sort, ensuring the associated indices remain
-            // in ascending order.
-            sort(irec->second.begin(), irec->second.end(),
-                        [](const std::pair<float, std::size_t> & p1,
-                           const std::pair<float, std::size_t> & p2){
-                   return (p2.first < p1.first ||
-                           (!(p1.first < p2.first) && p2.second > p1.second));});
-        }
+    // Decide which locations take part in the sort.
+    std::vector<bool> sortable(nLocs, true);
+    if (missingSortValueTreatment == MissingSortValueTreatment::NO_SORT) {
+        // Records with at least one missing sort value are not sorted at all.
+        std::set<std::size_t> recordsContainingMissingSortValues;
+        for (std::size_t iloc = 0; iloc < nLocs; iloc++)
+          if (sortValueMissing[iloc])
+            recordsContainingMissingSortValues.insert(recnums_[iloc]);
+        if (!recordsContainingMissingSortValues.empty())
+          for (std::size_t iloc = 0; iloc < nLocs; iloc++)
+            if (recordsContainingMissingSortValues.count(recnums_[iloc]))
+              sortable[iloc] = false;
+    } else if (missingSortValueTreatment == MissingSortValueTreatment::IGNORE_MISSING) {
+        // Locations with missing sort values stay where they are; the remaining ones are
+        // sorted in the positions left.
+        sortable.assign(sortValueMissing.begin(), sortValueMissing.end());
+        sortable.flip();
     }
 
-    // Copy indexing to the recidx_ data member.
-    for (TmpRecIdxIter irec = TmpRecIdx.begin(); irec != TmpRecIdx.end(); ++irec) {
-        const size_t recnum = irec->first;
-        recidx_[recnum].resize(irec->second.size());
-        if (missingSortValueTreatment == MissingSortValueTreatment::SORT ||
-            missingSortValueTreatment == MissingSortValueTreatment::NO_SORT) {
-          for (std::size_t iloc = 0; iloc < irec->second.size(); iloc++) {
-            recidx_[recnum][iloc] = irec->second[iloc].second;
-          }
-        } else if (missingSortValueTreatment == MissingSortValueTreatment::IGNORE_MISSING) {
-          // Locations with missing sort values in this record.
-          const std::vector<std::size_t> locations_missing = TmpRecIdx_missing[recnum];
-          // Locations with non-missing sort values in this record.
-          const std::vector<std::pair<float, std::size_t>> locations_present = TmpRecIdx[recnum];
-          // Whether or not sort values are missing at each location in this record.
-          const std::vector<bool> sortValueMissingInThisRecord = sortValueMissingInRecord[recnum];
-          recidx_[recnum].resize(sortValueMissingInThisRecord.size());
-          // Indices of locations with a non-missing sort value.
-          std::vector<std::size_t> locations_present_vector;
-          for (std::size_t iloc = 0; iloc < locations_present.size(); ++iloc) {
-            locations_present_vector.push_back(locations_present[iloc].second);
-          }
-          // Counts of missing and non-missing locations.
-          std::size_t count_present = 0;
-          std::size_t count_missing = 0;
-          for (std::size_t iloc = 0; iloc < sortValueMissingInThisRecord.size(); ++iloc) {
-            if (sortValueMissingInThisRecord[iloc]) {
-              recidx_[recnum][iloc] = locations_missing[count_missing++];
-            } else {
-              recidx_[recnum][iloc] = locations_present_vector[count_present++];
-            }
-          }
-        }
-    }
+    recidx_ = RecordIndex(recnums_);
+    recidx_.sortLocations(sortKeys, sortable);
 }
 
 // -----------------------------------------------------------------------------
 void ObsSpace::buildRecIdxUnsorted() {
-  std::size_t nLocs = this->nlocs();
-  for (size_t iloc = 0; iloc < nLocs; iloc++) {
-    recidx_[recnums_[iloc]].push_back(iloc);
-  }
+  recidx_ = RecordIndex(recnums_);
 }
 
 // -----------------------------------------------------------------------------
 template <typename DataType>
 void ObsSpace::extendVariable(Variable & extendVar,
-                              const size_t upperBoundOnGlobalNumOriginalRecs) {
+                              const size_t upperBoundOnGlobalNumOriginalRecs,
+                              const size_t numOriginalLocs,
+                              const size_t companionRecordLength) {
     const DataType missing = util::missingValue(missing);
 
     // Read in variable data values. At this point the values will contain
@@ -1224,6 +1917,11 @@ void ObsSpace::extendVariable(Variable & extendVar,
     std::vector<DataType> varVals;
     extendVar.read<DataType>(varVals);
 
+    // Companion records are stored after all original records, in the same order, and each
+    // occupies a contiguous block of companionRecordLength locations. So the locations of the
+    // companion of the n'th original record can be computed directly instead of being looked
+    // up in recidx_.
+    size_t companionLocBegin = numOriginalLocs;
     for (const auto & recordindex : recidx_) {
       // Only deal with records in the original ObsSpace.
       if (recordindex.first >= upperBoundOnGlobalNumOriginalRecs) break;
@@ -1240,10 +1938,10 @@ void ObsSpace::extendVariable(Variable & extendVar,
       // Fill the companion record with the first non-missing value in the original record.
       // (If all values are missing, do nothing.)
       if (fillValue != missing) {
-        for (const auto & jloc : recidx_[recordindex.first + upperBoundOnGlobalNumOriginalRecs]) {
-          varVals[jloc] = fillValue;
-        }
+        std::fill(varVals.begin() + companionLocBegin,
+                  varVals.begin() + companionLocBegin + companionRecordLength, fillValue);
       }
+      companionLocBegin += companionRecordLength;
     }
 
     // Write out values of the companion record.
@@ -1268,8 +1966,8 @@ void ObsSpace::extendObsSpace(const ObsExtendParameters & params) {
   if (nlevs > 0 &&
       gnlocs_ > 0 &&
       recordsExist) {
-    // Identify the indices of all local original records.
-    const std::set<size_t> uniqueOriginalRecs(recnums_.begin(), recnums_.end());
+    // The keys of recidx_ are the indices of all local original records, in increasing order.
+    const size_t numOriginalRecs = recidx_.size();
 
     // Find the largest global indices of locations and records in the original ObsSpace.
     // Increment them by one to produce the initial values for the global indices of locations
@@ -1281,46 +1979,64 @@ void ObsSpace::extendObsSpace(const ObsExtendParameters & params) {
     size_t upperBoundOnGlobalNumOriginalRecs = 0;
     if (numOriginalLocs > 0) {
       upperBoundOnGlobalNumOriginalLocs = indx_.back() + 1;
-      upperBoundOnGlobalNumOriginalRecs = *uniqueOriginalRecs.rbegin() + 1;
+      upperBoundOnGlobalNumOriginalRecs = recidx_.recordNumbers().back() + 1;
     }
-    dist_->max(upperBoundOnGlobalNumOriginalLocs);
-    dist_->max(upperBoundOnGlobalNumOriginalRecs);
+    ReductionBatch batch(*dist_);
+    batch.max(upperBoundOnGlobalNumOriginalLocs);
+    batch.max(upperBoundOnGlobalNumOriginalRecs);
+    batch.execute();
 
     // The replica distribution will be used to place each companion record on the same process
     // as the corresponding original record.
     std::shared_ptr<Distribution> replicaDist = createReplicaDistribution(
           commMPI_, dist_, recnums_);
 
-    // Create companion locations and records.
+    // Create companion locations and records. All the vectors indexed by location grow by the
+    // same known amount, so reserve their storage once and assign the companion locations
+    // to the replica distribution in a single batch.
+    const size_t numCompanionLocs = numOriginalRecs * nlevs;
+    const size_t numExtendedLocs = numOriginalLocs + numCompanionLocs;
+    recnums_.reserve(numExtendedLocs);
+    indx_.reserve(numExtendedLocs);
+    std::vector<size_t> companionRecs;
+    std::vector<size_t> globalCompanionLocs;
+    companionRecs.reserve(numCompanionLocs);
+    globalCompanionLocs.reserve(numCompanionLocs);
 
     // Local index of a companion location. Note that these indices, like local indices of
     // original locations, start from 0.
     size_t companionLoc = 0;
-    for (size_t originalRec : uniqueOriginalRecs) {
+    // Companion records have larger indices than all original records, so each of them can be
+    // appended to the end of recidx_.
+    const std::vector<size_t> originalRecs = recidx_.recordNumbers();
+    recidx_.reserve(2 * numOriginalRecs, numExtendedLocs);
+    for (size_t originalRec : originalRecs) {
       ASSERT(dist_->isMyRecord(originalRec));
       const size_t companionRec = originalRec;
       const size_t extendedRec = upperBoundOnGlobalNumOriginalRecs + companionRec;
       nrecs_++;
       // recidx_ stores the locations belonging to each record on the local processor.
-      std::vector<size_t> &locsInRecord = recidx_[extendedRec];
+      recidx_.appendRecord(extendedRec);
       for (int ilev = 0; ilev < nlevs; ++ilev, ++companionLoc) {
         const size_t extendedLoc = numOriginalLocs + companionLoc;
         const size_t globalCompanionLoc = originalRec * nlevs + ilev;
         const size_t globalExtendedLoc = upperBoundOnGlobalNumOriginalLocs + globalCompanionLoc;
-        // Geographical position shouldn't matter -- the replica distribution is expected
-        // to assign records to processors solely on the basis of their indices.
-        replicaDist->assignRecord(companionRec, globalCompanionLoc, eckit::geometry::Point2());
-        ASSERT(replicaDist->isMyRecord(companionRec));
+        companionRecs.push_back(companionRec);
+        globalCompanionLocs.push_back(globalCompanionLoc);
         recnums_.push_back(extendedRec);
         indx_.push_back(globalExtendedLoc);
-        locsInRecord.push_back(extendedLoc);
+        recidx_.appendLocation(extendedLoc);
       }
     }
+    ASSERT(companionLoc == numCompanionLocs);
+    // Geographical position shouldn't matter -- the replica distribution is expected
+    // to assign records to processors solely on the basis of their indices.
+    replicaDist->assignRecords(companionRecs, globalCompanionLocs,
+                               std::vector<eckit::geometry::Point2>(numCompanionLocs));
+    for (size_t originalRec : originalRecs)
+      ASSERT(replicaDist->isMyRecord(originalRec));
     replicaDist->computePatchLocs();
 
-    const size_t numCompanionLocs = companionLoc;
-    const size_t numExtendedLocs = numOriginalLocs + numCompanionLocs;
-
     // Extend all existing vectors with missing values.
     // Only vectors with (at least) one dimension equal to nlocs are modified.
     // Second argument (bool) to resizeNlocs tells function:
@@ -1350,7 +2066,8 @@ void ObsSpace::extendObsSpace(const ObsExtendParameters & params) {
               extendVar,
               [&](auto typeDiscriminator) {
                   typedef decltype(typeDiscriminator) T;
-                  extendVariable<T>(extendVar, upperBoundOnGlobalNumOriginalRecs);
+                  extendVariable<T>(extendVar, upperBoundOnGlobalNumOriginalRecs,
+                                    numOriginalLocs, nlevs);
               },
               VarUtils::ThrowIfVariableIsOfUnsupportedType(fullVname));
       }
@@ -16,12 +16,17 @@
 #ifndef OBSSPACE_H_
 #define OBSSPACE_H_
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <ostream>
 #include <set>
+#include <shared_mutex>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
@@ -35,6 +40,7 @@
 #include "oops/util/DateTime.h"
 #include "oops/util/Logger.h"
 #include "ioda/core/IodaUtils.h"
+#include "ioda/core/RecordIndex.h"
 #include "ioda/distribution/Distribution.h"
 #include "ioda/Misc/Dimensions.h"
 #include "ioda/ObsGroup.h"
@@ -48,6 +54,7 @@ namespace eckit {
 }
 
 namespace ioda {
+    class IoPool;
     class ObsFrameRead;
     class ObsVector;
 
@@ -72,6 +79,28 @@ namespace ioda {
         Nchans
     };
 
+    /// \brief Handle to a save of an ObsSpace running in the background
+    /// \details Returned by ObsSpace::saveAsync(). A default constructed handle, or the handle
+    /// of a save that was done in the foreground, is complete from the start.
+    class SaveHandle {
+     public:
+        SaveHandle() {}
+        explicit SaveHandle(std::shared_future<void> future) : future_(std::move(future)) {}
+
+        /// \brief wait for the output file to be written
+        /// \details Rethrows any exception thrown while writing the file.
+        void wait() const { if (future_.valid()) future_.get(); }
+
+        /// \brief return true if the output file has been written
+        bool done() const {
+            return !future_.valid() ||
+                   (future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        }
+
+     private:
+        std::shared_future<void> future_;
+    };
+
     /// \brief Wrapper class that maps dimension ids to names.
     class ObsDimInfo {
      public:
@@ -123,10 +152,15 @@ namespace ioda {
     /// During the DA run, all data transfers are done in memory. The only time file I/O is
     /// invoked is during the constructor (read from the file into the obs container) and
     /// optionally during the the destructor (write from obs container into the file).
+    ///
+    /// get_db(), get_time_offsets(), epoch(), has() and dtype() can be called concurrently
+    /// from multiple threads, and so can put_db(), provided that no two threads access the
+    /// same variable at the same time unless they all only read it. Other non-const functions
+    /// (e.g. save(), rebalance()) must not run concurrently with any other function.
     class ObsSpace : public oops::ObsSpaceBase {
      public:
         //---------------------------- typedefs -------------------------------
-        typedef std::map<std::size_t, std::vector<std::size_t>> RecIdxMap;
+        typedef RecordIndex RecIdxMap;
         typedef RecIdxMap::const_iterator RecIdxIter;
         typedef ObsTopLevelParameters Parameters_;
 
@@ -150,7 +184,7 @@ namespace ioda {
                 const util::DateTime & bgn, const util::DateTime & end,
                 const eckit::mpi::Comm & timeComm);
         ObsSpace(const ObsSpace &);
-        virtual ~ObsSpace() {}
+        virtual ~ObsSpace();
 
         /// @}
         /// @name Constructor-defined parameters
@@ -188,6 +222,57 @@ namespace ioda {
         ///          from different sources during the clean up after a job completes.
         void save();
 
+        /// \brief start saving the obs space data into a file in the background
+        /// \details The variables are first copied into a staging group, so the obs space
+        ///          can be modified and even destroyed while the file is written. The transfers
+        ///          to the io pool and the file writes run on a background thread, which
+        ///          communicates on a duplicate of the obs space communicator. The returned
+        ///          handle can be waited on; the save is also completed by the next save or by
+        ///          the destructor. This is a collective operation.
+        ///
+        ///          Writing in the background requires the MPI library to provide full thread
+        ///          support (MPI_THREAD_MULTIPLE) and the HDF5 library to be thread safe.
+        ///          Otherwise this function saves in the foreground like save(), and returns
+        ///          a handle that is already complete.
+        ///
+        ///          save() calls this function if the obsdataout "asynchronous save" option
+        ///          is set.
+        SaveHandle saveAsync();
+
+        /// \brief write a report of the memory used by the obs space variables to \p os
+        /// \details The bytes used by each variable (elements, unused capacity, heap buffers of
+        ///          long strings and attributes) are reduced over all MPI tasks of the obs
+        ///          space, and the minimum, maximum and sum over tasks are reported for each
+        ///          variable and each group. This is a collective operation; only the root task
+        ///          writes to \p os.
+        ///
+        ///          The report is also written to oops::Log::info() at the end of the
+        ///          constructor and at the start of save() if the "log memory usage" option
+        ///          is set.
+        void printMemoryReport(std::ostream & os) const;
+
+        /// @}
+        /// @name Load balancing
+        /// @{
+
+        /// \brief Move whole records between MPI tasks to balance the numbers of active locations.
+        ///
+        /// \details After thinning and gross-error checks, the numbers of active locations held
+        /// by individual tasks can differ widely, and the slowest task sets the cost of H(x) and
+        /// of the minimization. This function moves records (with all their variables) from tasks
+        /// holding more active locations than average to tasks holding fewer, exchanging the
+        /// data of all variables in a single packed all-to-all operation. Records without active
+        /// locations are not moved.
+        ///
+        /// The locations held by each task change, so objects whose layout depends on them
+        /// (ObsVector, ObsDataVector etc.) must be created after calling this function. This is
+        /// a collective operation. It is only supported for non-overlapping distributions (in
+        /// particular, not for extended ObsSpaces).
+        ///
+        /// \param activeLocs Vector of length nlocs() indicating which locations are active.
+        /// \return The new distribution, which is also returned by distribution() from now on.
+        std::shared_ptr<const Distribution> rebalance(const std::vector<bool> & activeLocs);
+
         /// @}
         /// @name General querying functions
         /// @{
@@ -309,7 +394,10 @@ namespace ioda {
         /// @{
 
         /// \brief return the ObsGroup that stores the data
-        inline ObsGroup getObsGroup() { return obs_group_; }
+        /// \details Writes made through the returned group are not tracked by the incremental
+        ///          save (see the obsdataout "incremental save" option), so calling this
+        ///          function makes the next save rewrite the whole output file.
+        inline ObsGroup getObsGroup() { full_save_needed_ = true; return obs_group_; }
 
         /// \brief return the ObsGroup that stores the data
         inline const ObsGroup getObsGroup() const { return obs_group_; }
@@ -361,6 +449,55 @@ namespace ioda {
                     const std::vector<int> & chanSelect = { },
                     bool skipDerived = false) const;
 
+        /// \brief transfer the time offsets stored in a date/time variable from the obs container
+        ///
+        /// \details Date/time variables are stored as offsets in seconds from an epoch held in
+        /// their `units` attribute. This function returns the offsets and the epoch without
+        /// constructing a util::DateTime object for each location, which is much cheaper when
+        /// the caller only needs to compare times (e.g. with windowStartOffset() and
+        /// windowEndOffset()). Missing values are set to util::missingValue(int64_t).
+        ///
+        /// \param group Name of container group (usually MetaData)
+        /// \param name  Name of container variable
+        /// \param offsets Vector where the time offsets (in seconds) are being transferred to
+        /// \param epoch Set to the epoch of the variable
+        /// \param chanSelect Channel selection (list of channel numbers)
+        /// \param skipDerived Same meaning as in get_db()
+        void get_time_offsets(const std::string & group, const std::string & name,
+                              std::vector<int64_t> & offsets, util::DateTime & epoch,
+                              const std::vector<int> & chanSelect = { },
+                              bool skipDerived = false) const;
+
+        /// \brief return the epoch of a date/time variable
+        ///
+        /// \details The `units` attribute of each variable is parsed only once; the result is
+        /// cached for subsequent calls to this function and the DateTime versions of get_db()
+        /// and put_db().
+        ///
+        /// \param group Name of container group (usually MetaData)
+        /// \param name  Name of container variable
+        /// \param skipDerived Same meaning as in get_db()
+        const util::DateTime & epoch(const std::string & group, const std::string & name,
+                                     bool skipDerived = false) const;
+
+        /// \brief return the offset in seconds of the start of the DA timing window from `epoch`
+        std::int64_t windowStartOffset(const util::DateTime & epoch) const {
+            return (winbgn_ - epoch).toSeconds();
+        }
+
+        /// \brief return the offset in seconds of the end of the DA timing window from `epoch`
+        std::int64_t windowEndOffset(const util::DateTime & epoch) const {
+            return (winend_ - epoch).toSeconds();
+        }
+
+        /// \brief return a vector indicating which time offsets from `epoch` lie inside the
+        /// DA timing window
+        ///
+        /// \details Uses the same convention as the selection of observations on input: the
+        /// window excludes its start and includes its end. Missing offsets lie outside.
+        std::vector<bool> insideTimeWindow(const std::vector<int64_t> & offsets,
+                                           const util::DateTime & epoch) const;
+
         /// \brief transfer data from vdata to the obs container
         ///
         /// \details The following put_db methods are the same except for the data type
@@ -422,6 +559,16 @@ namespace ioda {
         /// \param recNum Record number being searched for
         const std::vector<std::size_t> & recidx_vector(const std::size_t recNum) const;
 
+        /// \brief return a view of the locations of the record pointed to by the given iterator
+        ///
+        /// Unlike recidx_vector(), this function does not copy the locations into a vector.
+        /// \param irec Iterator into the recidx_ data member
+        RecordIndex::Locations recidx_locations(const RecIdxIter & irec) const;
+
+        /// \brief return a view of the locations of the record with the given record number
+        /// \param recNum Record number being searched for
+        RecordIndex::Locations recidx_locations(const std::size_t recNum) const;
+
         /// \brief return all record numbers from the recidx_ data member
         std::vector<std::size_t> recidx_all_recnums() const;
 
@@ -502,6 +649,38 @@ namespace ioda {
         /// \brief cache for backend selection
         std::map<VarUtils::Vec_Named_Variable, Selection> known_be_selections_;
 
+        /// \brief epochs of date/time variables, indexed by full variable name
+        mutable std::map<std::string, util::DateTime> epochs_;
+
+        /// \brief guards epochs_
+        mutable std::mutex epochs_mutex_;
+
+        /// \brief guards the set of variables held in obs_group_
+        ///
+        /// \details Held in shared mode by functions reading variables or writing to existing
+        /// ones and in exclusive mode by functions creating variables.
+        mutable std::shared_timed_mutex mutex_;
+
+        /// \brief io pool of an asynchronous save that has not been finalized yet
+        std::unique_ptr<IoPool> pending_io_pool_;
+
+        /// \brief completion of a save running in the background (see saveAsync())
+        std::shared_future<void> pending_save_;
+
+        /// \brief name of the communicator used by the save running in the background
+        std::string save_comm_name_;
+
+        /// \brief names of the variables written by put_db since the previous save
+        std::set<std::string> modified_vars_;
+
+        /// \brief guards modified_vars_
+        std::mutex modified_vars_mutex_;
+
+        /// \brief true if the next save must write all of the variables
+        /// \details Set until the first save, and whenever the locations change (e.g. by
+        ///          rebalance()) or a save fails.
+        bool full_save_needed_;
+
         /// \brief disable the "=" operator
         ObsSpace & operator= (const ObsSpace &) = delete;
 
@@ -510,6 +689,42 @@ namespace ioda {
         /// \param os output stream
         void print(std::ostream & os) const;
 
+        /// \brief implementation of has() (the caller must hold mutex_)
+        bool hasVar(const std::string & group, const std::string & name,
+                    bool skipDerived) const;
+
+        /// \brief return the (cached) epoch of the date/time variable `fullName`
+        /// (the caller must hold mutex_)
+        const util::DateTime & cachedEpoch(const std::string & fullName) const;
+
+        /// \brief finalize the io pool of an asynchronous save (if any)
+        /// \details On the ranks outside the io pool this waits for the data transfers to
+        ///          the io pool to complete. On the io pool ranks this waits for all of the
+        ///          io pool ranks to finish writing the output file. A save running in the
+        ///          background is waited for, and any error it raised is rethrown.
+        void finalizePendingSave();
+
+        /// \brief save the obs space data into a file on the calling thread
+        void saveInForeground();
+
+        /// \brief collect the names of the variables to be written by an incremental save
+        /// \details Returns false if all of the variables must be written, i.e. unless
+        ///          the obsdataout "incremental save" option is set and none of the tasks
+        ///          needs a full save. Otherwise \p varNames is set to the union over all
+        ///          tasks of the variables modified since the previous save. This is a
+        ///          collective operation.
+        bool collectModifiedVars(std::vector<std::string> & varNames);
+
+        /// \brief return the group to be written to the output file
+        /// \details Unless the obsdataout options select some of the variables or drop some
+        ///          of the locations, this is obs_group_ itself (or a copy of it if
+        ///          \p alwaysCopy is true). Otherwise it is a copy holding the selected
+        ///          variables at the kept locations, so that the rest is never transferred
+        ///          to the io pool.
+        /// \param alwaysCopy return a copy even if nothing is filtered out
+        /// \param outputNlocs set to the number of locations in the returned group
+        Group outputGroup(const bool alwaysCopy, std::size_t & outputNlocs) const;
+
         /// \brief Initialize the database from a source (ObsFrame ojbect)
         /// \param obsFrame obs source object
         void createObsGroupFromObsFrame(ObsFrameRead & obsFrame);
@@ -535,6 +750,10 @@ namespace ioda {
         /// any particular ordering of the record groups.
         void buildRecIdxUnsorted();
 
+        /// \brief Return an iterator to the record `recNum` in recidx_; abort if there is none.
+        /// \param caller Name of the calling function, used in the error message
+        RecIdxIter findRecord(const std::size_t recNum, const std::string & caller) const;
+
         /// \brief initialize the in-memory obs_group_ (ObsGroup) object from the ObsIo source
         /// \param obsIo obs source object
         void initFromObsSource(ObsFrameRead & obsFrame);
@@ -679,8 +898,11 @@ namespace ioda {
         /// \param extendVar database variable to be extended
         /// \param upperBoundOnGlobalNumOriginalRecs upper bound, across all processors,
         ///        of the number of records in the original ObsSpace.
+        /// \param numOriginalLocs number of locations held on this processor before the extension.
+        /// \param companionRecordLength number of locations in each companion record.
         template <typename DataType>
-        void extendVariable(Variable & extendVar, const size_t upperBoundOnGlobalNumOriginalRecs);
+        void extendVariable(Variable & extendVar, const size_t upperBoundOnGlobalNumOriginalRecs,
+                            const size_t numOriginalLocs, const size_t companionRecordLength);
     };
 
 }  // namespace ioda
@@ -54,6 +54,18 @@ class ObsExtendParameters : public oops::Parameters {
             this};
 };
 
+class ObsStorageParameters : public oops::Parameters {
+    OOPS_CONCRETE_PARAMETERS(ObsStorageParameters, oops::Parameters)
+
+ public:
+    /// Directory holding the scratch files backing memory-mapped variables (preferably on
+    /// node-local tmpfs or NVMe storage).
+    oops::RequiredParameter<std::string> scratchDirectory{"scratch directory", this};
+
+    /// Variables whose values take more than this number of bytes on a task are memory-mapped.
+    oops::Parameter<size_t> mappedThreshold{"threshold", 16 * 1024 * 1024, this};
+};
+
 class ObsTopLevelParameters : public oops::ObsSpaceParametersBase {
     OOPS_CONCRETE_PARAMETERS(ObsTopLevelParameters, ObsSpaceParametersBase)
 
@@ -90,6 +102,13 @@ class ObsTopLevelParameters : public oops::ObsSpaceParametersBase {
 
     /// output specification by writing to a file
     oops::OptionalParameter<ObsDataOutParameters> obsDataOut{"obsdataout", this};
+
+    /// keep large variables in memory-mapped scratch files instead of heap memory
+    oops::OptionalParameter<ObsStorageParameters> memoryMappedStorage{"memory-mapped storage",
+                                                                      this};
+
+    /// log the memory used by each variable after construction and before saving
+    oops::Parameter<bool> logMemoryUsage{"log memory usage", false, this};
 };
 
 class ObsSpaceParameters {
@@ -12,6 +12,7 @@
 
 #include "eckit/config/LocalConfiguration.h"
 #include "ioda/distribution/DistributionUtils.h"
+#include "ioda/distribution/ReductionBatch.h"
 #include "ioda/ObsDataVector.h"
 #include "ioda/ObsSpace.h"
 #include "oops/base/Variables.h"
@@ -169,6 +170,7 @@ double ObsVector::dot_product_with(const ObsVector & other) const {
 // -----------------------------------------------------------------------------
 std::vector<double> ObsVector::multivar_dot_product_with(const ObsVector & other) const {
   std::vector<double> result(nvars_, 0);
+  ReductionBatch batch(*obsdb_.distribution());
   for (size_t jvar = 0; jvar < nvars_; ++jvar) {
     // fill vectors for current variable (note: if elements in values_
     // were distributed as all locs for var1; all locs for var2; etc, we
@@ -179,14 +181,19 @@ std::vector<double> ObsVector::multivar_dot_product_with(const ObsVector & other
       x1[jloc] = values_[jvar + (jloc * nvars_)];
       x2[jloc] = other.values_[jvar + (jloc*nvars_)];
     }
-    result[jvar] = dotProduct(*obsdb_.distribution(), 1, x1, x2);
+    dotProduct(batch, *obsdb_.distribution(), 1, x1, x2, result[jvar]);
   }
+  batch.execute();
   return result;
 }
 // -----------------------------------------------------------------------------
 double ObsVector::rms() const {
-  double zrms = dot_product_with(*this);
-  int nobs = this->nobs();
+  double zrms;
+  std::size_t nobs;
+  ReductionBatch batch(*obsdb_.distribution());
+  dotProduct(batch, *obsdb_.distribution(), nvars_, values_, values_, zrms);
+  globalNumNonMissingObs(batch, *obsdb_.distribution(), nvars_, values_, nobs);
+  batch.execute();
   if (nobs > 0) zrms = sqrt(zrms / static_cast<double>(nobs));
 
   return zrms;
@@ -303,8 +310,11 @@ double & ObsVector::toFortran() {
 void ObsVector::print(std::ostream & os) const {
   double zmin = std::numeric_limits<double>::max();
   double zmax = std::numeric_limits<double>::lowest();
-  double zrms = rms();
-  int nobs = this->nobs();
+  double zrms;
+  std::size_t nobs;
+  ReductionBatch batch(*obsdb_.distribution());
+  dotProduct(batch, *obsdb_.distribution(), nvars_, values_, values_, zrms);
+  globalNumNonMissingObs(batch, *obsdb_.distribution(), nvars_, values_, nobs);
   for (size_t jj = 0; jj < values_.size() ; ++jj) {
     if (values_[jj] != missing_) {
       if (values_[jj] < zmin) zmin = values_[jj];
@@ -312,10 +322,12 @@ void ObsVector::print(std::ostream & os) const {
     }
   }
 
-  obsdb_.distribution()->min(zmin);
-  obsdb_.distribution()->max(zmax);
+  batch.min(zmin);
+  batch.max(zmax);
+  batch.execute();
 
   if (nobs > 0) {
+    zrms = sqrt(zrms / static_cast<double>(nobs));
     os << obsdb_.obsname() << " nobs= " << nobs << " Min="
        << zmin << ", Max=" << zmax << ", RMS=" << zrms << std::endl;
   } else {
@@ -0,0 +1,145 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "ioda/core/RecordIndex.h"
+
+#include <array>
+#include <utility>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace ioda {
+
+namespace {
+
+// -----------------------------------------------------------------------------
+/// \brief Stable LSD radix sort of `items` in increasing order of `keys[item]`.
+///
+/// The sort runs over bytes of the keys from the least to the most significant one; passes
+/// over bytes that are the same for all keys (e.g. the high bytes of time offsets) are skipped.
+void radixSort(std::vector<std::size_t> &items, const std::vector<std::uint64_t> &keys) {
+  const std::size_t numBuckets = 256;
+  std::vector<std::size_t> sorted(items.size());
+  for (int shift = 0; shift < 64; shift += 8) {
+    std::array<std::size_t, numBuckets + 1> offsets{};
+    for (std::size_t item : items)
+      ++offsets[((keys[item] >> shift) & 0xff) + 1];
+    bool allInOneBucket = false;
+    for (std::size_t bucket = 1; bucket <= numBuckets; ++bucket) {
+      if (offsets[bucket] == items.size()) {
+        allInOneBucket = true;
+        break;
+      }
+    }
+    if (allInOneBucket)
+      continue;
+    for (std::size_t bucket = 1; bucket <= numBuckets; ++bucket)
+      offsets[bucket] += offsets[bucket - 1];
+    for (std::size_t item : items)
+      sorted[offsets[(keys[item] >> shift) & 0xff]++] = item;
+    items.swap(sorted);
+  }
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+RecordIndex::RecordIndex(const std::vector<std::size_t> &recnums) {
+  const std::size_t nlocs = recnums.size();
+
+  // Find the distinct record numbers.
+  recnums_ = recnums;
+  std::sort(recnums_.begin(), recnums_.end());
+  recnums_.erase(std::unique(recnums_.begin(), recnums_.end()), recnums_.end());
+
+  // Count the locations in each record and scatter them to their slots (a counting sort, which
+  // keeps the locations of each record in increasing order).
+  std::vector<std::size_t> recordOfLoc(nlocs);
+  offsets_.assign(recnums_.size() + 1, 0);
+  for (std::size_t loc = 0; loc < nlocs; ++loc) {
+    recordOfLoc[loc] = std::lower_bound(recnums_.begin(), recnums_.end(), recnums[loc]) -
+        recnums_.begin();
+    ++offsets_[recordOfLoc[loc] + 1];
+  }
+  for (std::size_t irec = 0; irec < recnums_.size(); ++irec)
+    offsets_[irec + 1] += offsets_[irec];
+
+  locs_.resize(nlocs);
+  std::vector<std::size_t> next(offsets_.begin(), offsets_.end() - 1);
+  for (std::size_t loc = 0; loc < nlocs; ++loc)
+    locs_[next[recordOfLoc[loc]]++] = loc;
+}
+
+// -----------------------------------------------------------------------------
+RecordIndex::RecordIndex(RecordIndex &&other)
+  : recnums_(std::move(other.recnums_)), offsets_(std::move(other.offsets_)),
+    locs_(std::move(other.locs_)), vectorCache_(std::move(other.vectorCache_)) {
+  other.clear();
+}
+
+// -----------------------------------------------------------------------------
+RecordIndex &RecordIndex::operator=(RecordIndex &&other) {
+  if (this != &other) {
+    recnums_ = std::move(other.recnums_);
+    offsets_ = std::move(other.offsets_);
+    locs_ = std::move(other.locs_);
+    vectorCache_ = std::move(other.vectorCache_);
+    other.clear();
+  }
+  return *this;
+}
+
+// -----------------------------------------------------------------------------
+const std::vector<std::size_t> &RecordIndex::locationsVector(std::size_t irec) const {
+  ASSERT(irec < recnums_.size());
+  std::lock_guard<std::mutex> lock(vectorCacheMutex_);
+  if (vectorCache_.size() != recnums_.size())
+    vectorCache_.resize(recnums_.size());
+  std::unique_ptr<const std::vector<std::size_t>> &locations = vectorCache_[irec];
+  if (!locations)
+    locations.reset(new std::vector<std::size_t>(locs_.begin() + offsets_[irec],
+                                                 locs_.begin() + offsets_[irec + 1]));
+  return *locations;
+}
+
+// -----------------------------------------------------------------------------
+void RecordIndex::sortLocations(const std::vector<std::uint64_t> &keys,
+                                const std::vector<bool> &sortable) {
+  ASSERT(keys.size() == sortable.size());
+  vectorCache_.clear();
+
+  // Sort all sortable locations by key. The radix sort is stable and the locations start in
+  // increasing order, so ties end up ordered by location index.
+  const std::size_t noRecord = static_cast<std::size_t>(-1);
+  std::vector<std::size_t> recordOfLoc(keys.size(), noRecord);
+  for (std::size_t irec = 0; irec < recnums_.size(); ++irec) {
+    for (std::size_t i = offsets_[irec]; i < offsets_[irec + 1]; ++i) {
+      ASSERT(locs_[i] < keys.size());
+      recordOfLoc[locs_[i]] = irec;
+    }
+  }
+  std::vector<std::size_t> sortedLocs;
+  sortedLocs.reserve(locs_.size());
+  for (std::size_t loc = 0; loc < keys.size(); ++loc)
+    if (sortable[loc] && recordOfLoc[loc] != noRecord)
+      sortedLocs.push_back(loc);
+  radixSort(sortedLocs, keys);
+
+  // Distribute the sorted locations to the slots of their records previously occupied by
+  // sortable locations.
+  std::vector<std::size_t> newLocs(locs_);
+  std::vector<std::size_t> next(offsets_.begin(), offsets_.end() - 1);
+  for (std::size_t loc : sortedLocs) {
+    std::size_t &slot = next[recordOfLoc[loc]];
+    while (!sortable[locs_[slot]])
+      ++slot;
+    newLocs[slot++] = loc;
+  }
+  locs_.swap(newLocs);
+}
+
+}  // namespace ioda
@@ -0,0 +1,209 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef CORE_RECORDINDEX_H_
+#define CORE_RECORDINDEX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ioda {
+
+// ---------------------------------------------------------------------
+/*!
+ * \brief Locations belonging to each record held on the current process.
+ *
+ * \details The index is stored in compressed sparse row form: a sorted vector of record
+ *          numbers, a vector of offsets and a single vector holding the locations of all records
+ *          one after another. Compared with a std::map from record numbers to vectors of
+ *          locations this needs only three allocations, and walking through all records reads
+ *          contiguous memory.
+ *
+ *          Iterators dereference to objects with members `first` (the record number) and
+ *          `second` (a view of the record's locations), so code written for the map keeps
+ *          working. Callers needing the locations of a record as a std::vector can get a
+ *          reference to one from locationsVector(); these vectors are created on demand.
+ */
+class RecordIndex {
+ public:
+  /// \brief Read-only view of the locations belonging to a single record.
+  class Locations {
+   public:
+    typedef std::size_t value_type;
+    typedef const std::size_t * const_iterator;
+    typedef const_iterator iterator;
+
+    Locations(const std::size_t *begin, const std::size_t *end) : begin_(begin), end_(end) {}
+
+    const_iterator begin() const { return begin_; }
+    const_iterator end() const { return end_; }
+    std::size_t size() const { return end_ - begin_; }
+    bool empty() const { return begin_ == end_; }
+    std::size_t operator[](std::size_t i) const { return begin_[i]; }
+    std::size_t front() const { return *begin_; }
+    std::size_t back() const { return *(end_ - 1); }
+
+    /// \brief Return a copy of the locations.
+    operator std::vector<std::size_t>() const { return std::vector<std::size_t>(begin_, end_); }
+
+   private:
+    const std::size_t *begin_;
+    const std::size_t *end_;
+  };
+
+  /// \brief A record number together with the locations belonging to that record.
+  struct Record {
+    std::size_t first;
+    Locations second;
+  };
+
+  class const_iterator {
+   public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef Record value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Record reference;
+
+    /// Makes `iter->first` and `iter->second` valid although records are produced on the fly.
+    class pointer {
+     public:
+      explicit pointer(const Record &record) : record_(record) {}
+      const Record *operator->() const { return &record_; }
+     private:
+      Record record_;
+    };
+
+    const_iterator() : index_(nullptr), irec_(0) {}
+    const_iterator(const RecordIndex *index, std::size_t irec) : index_(index), irec_(irec) {}
+
+    Record operator*() const { return index_->record(irec_); }
+    pointer operator->() const { return pointer(index_->record(irec_)); }
+
+    const_iterator &operator++() { ++irec_; return *this; }
+    const_iterator operator++(int) { const_iterator old = *this; ++irec_; return old; }
+    const_iterator &operator--() { --irec_; return *this; }
+    const_iterator operator--(int) { const_iterator old = *this; --irec_; return old; }
+    const_iterator &operator+=(difference_type n) { irec_ += n; return *this; }
+    const_iterator &operator-=(difference_type n) { irec_ -= n; return *this; }
+    const_iterator operator+(difference_type n) const { return const_iterator(index_, irec_ + n); }
+    const_iterator operator-(difference_type n) const { return const_iterator(index_, irec_ - n); }
+    difference_type operator-(const const_iterator &other) const {
+      return static_cast<difference_type>(irec_) - static_cast<difference_type>(other.irec_);
+    }
+    Record operator[](difference_type n) const { return index_->record(irec_ + n); }
+
+    bool operator==(const const_iterator &other) const { return irec_ == other.irec_; }
+    bool operator!=(const const_iterator &other) const { return irec_ != other.irec_; }
+    bool operator<(const const_iterator &other) const { return irec_ < other.irec_; }
+    bool operator>(const const_iterator &other) const { return irec_ > other.irec_; }
+    bool operator<=(const const_iterator &other) const { return irec_ <= other.irec_; }
+    bool operator>=(const const_iterator &other) const { return irec_ >= other.irec_; }
+
+   private:
+    const RecordIndex *index_;
+    std::size_t irec_;
+  };
+  typedef const_iterator iterator;
+
+  RecordIndex() : offsets_(1, 0) {}
+
+  RecordIndex(RecordIndex &&other);
+  RecordIndex &operator=(RecordIndex &&other);
+  RecordIndex(const RecordIndex &) = delete;
+  RecordIndex &operator=(const RecordIndex &) = delete;
+
+  /// \brief Build an index of the records `recnums[loc]` containing locations `loc`.
+  ///
+  /// Locations in each record are stored in increasing order.
+  explicit RecordIndex(const std::vector<std::size_t> &recnums);
+
+  std::size_t size() const { return recnums_.size(); }
+  bool empty() const { return recnums_.empty(); }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size()); }
+
+  /// \brief Return an iterator to the record `recNum` or end() if there is no such record.
+  const_iterator find(std::size_t recNum) const {
+    const auto it = std::lower_bound(recnums_.begin(), recnums_.end(), recNum);
+    if (it == recnums_.end() || *it != recNum)
+      return end();
+    return const_iterator(this, it - recnums_.begin());
+  }
+
+  /// \brief Return the numbers of all records, in increasing order.
+  const std::vector<std::size_t> &recordNumbers() const { return recnums_; }
+
+  /// \brief Return the record with the given position in the index.
+  Record record(std::size_t irec) const {
+    return Record{recnums_[irec], Locations(locs_.data() + offsets_[irec],
+                                            locs_.data() + offsets_[irec + 1])};
+  }
+
+  /// \brief Return a vector holding the locations of the record with the given position in the
+  /// index.
+  ///
+  /// The vector is created on the first call and owned by the index. The reference stays valid
+  /// until the index is modified. This function may be called concurrently from several threads.
+  const std::vector<std::size_t> &locationsVector(std::size_t irec) const;
+
+  /// \brief Remove all records.
+  void clear() {
+    recnums_.clear();
+    offsets_.assign(1, 0);
+    locs_.clear();
+    vectorCache_.clear();
+  }
+
+  /// \brief Reserve space for `numRecs` records containing `numLocs` locations in total.
+  void reserve(std::size_t numRecs, std::size_t numLocs) {
+    recnums_.reserve(numRecs);
+    offsets_.reserve(numRecs + 1);
+    locs_.reserve(numLocs);
+  }
+
+  /// \brief Append a new (initially empty) record.
+  ///
+  /// \p recNum must be larger than the numbers of all records already in the index.
+  void appendRecord(std::size_t recNum) {
+    vectorCache_.clear();
+    recnums_.push_back(recNum);
+    offsets_.push_back(locs_.size());
+  }
+
+  /// \brief Append a location to the record added most recently.
+  void appendLocation(std::size_t loc) {
+    vectorCache_.clear();
+    locs_.push_back(loc);
+    ++offsets_.back();
+  }
+
+  /// \brief Reorder the locations within each record.
+  ///
+  /// Locations `loc` with `sortable[loc] == true` are sorted in increasing order of `keys[loc]`
+  /// (ties are broken by location index) and placed in the positions previously occupied by
+  /// sortable locations of the same record. All other locations keep their positions.
+  void sortLocations(const std::vector<std::uint64_t> &keys, const std::vector<bool> &sortable);
+
+ private:
+  std::vector<std::size_t> recnums_;
+  std::vector<std::size_t> offsets_;
+  std::vector<std::size_t> locs_;
+
+  /// Vectors returned by locationsVector(), indexed by record position.
+  mutable std::vector<std::unique_ptr<const std::vector<std::size_t>>> vectorCache_;
+  mutable std::mutex vectorCacheMutex_;
+};
+
+}  // namespace ioda
+
+#endif  // CORE_RECORDINDEX_H_
@@ -35,6 +35,14 @@ class Accumulator {
     /// \brief Return the sum of contributions associated with locations held on all PEs
     /// (each taken into account only once).
     virtual T computeResult() const = 0;
+
+    /// \brief Return the contribution of the current PE to the sum, i.e. a value such that the
+    /// sum of the values returned by this function on all PEs is equal to the result of
+    /// computeResult().
+    ///
+    /// This does not involve any communication, which makes it possible to compute multiple
+    /// sums with a single collective operation (see ReductionBatch).
+    virtual T computeLocalContribution() const = 0;
 };
 
 /// \brief Calculates the sums of multiple location-dependent quantities of type `T` over locations
@@ -58,6 +66,11 @@ class Accumulator<std::vector<T>> {
     /// \brief Return the sums of contributions associated with locations held on all
     /// PEs (each taken into account only once).
     virtual std::vector<T> computeResult() const = 0;
+
+    /// \brief Return the contributions of the current PE to the sums, i.e. a vector such that
+    /// the sum of the vectors returned by this function on all PEs is equal to the result of
+    /// computeResult().
+    virtual std::vector<T> computeLocalContribution() const = 0;
 };
 
 }  // namespace ioda
@@ -0,0 +1,105 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "ioda/distribution/AsyncReduction.h"
+
+#include <mpi.h>
+
+#include <limits>
+#include <string>
+
+namespace ioda {
+namespace detail {
+
+namespace {
+
+MPI_Datatype toMpiDatatype(eckit::mpi::Data::Code type) {
+  switch (type) {
+  case eckit::mpi::Data::INT:
+    return MPI_INT;
+  case eckit::mpi::Data::LONG:
+    return MPI_LONG;
+  case eckit::mpi::Data::UNSIGNED_LONG:
+    return MPI_UNSIGNED_LONG;
+  case eckit::mpi::Data::UNSIGNED_LONG_LONG:
+    return MPI_UNSIGNED_LONG_LONG;
+  case eckit::mpi::Data::FLOAT:
+    return MPI_FLOAT;
+  case eckit::mpi::Data::DOUBLE:
+    return MPI_DOUBLE;
+  default:
+    throw eckit::NotImplemented("AsyncReduction: unsupported data type", Here());
+  }
+}
+
+MPI_Op toMpiOp(eckit::mpi::Operation::Code op) {
+  switch (op) {
+  case eckit::mpi::Operation::SUM:
+    return MPI_SUM;
+  case eckit::mpi::Operation::MIN:
+    return MPI_MIN;
+  case eckit::mpi::Operation::MAX:
+    return MPI_MAX;
+  default:
+    throw eckit::NotImplemented("AsyncReduction: unsupported operation", Here());
+  }
+}
+
+void checkStatus(int status, const std::string &call) {
+  if (status != MPI_SUCCESS)
+    throw eckit::SeriousBug(call + " failed", Here());
+}
+
+}  // namespace
+
+class AsyncReductionRequest::Impl {
+ public:
+  MPI_Request request = MPI_REQUEST_NULL;
+};
+
+AsyncReductionRequest::AsyncReductionRequest(const eckit::mpi::Comm &comm, void *buffer,
+                                             std::size_t count, eckit::mpi::Data::Code type,
+                                             eckit::mpi::Operation::Code op) {
+  // On a single process there is nothing to reduce (this also avoids calling MPI when
+  // eckit uses its serial backend).
+  if (comm.size() <= 1 || count == 0)
+    return;
+  ASSERT(count <= static_cast<std::size_t>(std::numeric_limits<int>::max()));
+
+  impl_.reset(new Impl);
+  const MPI_Comm mpiComm = MPI_Comm_f2c(comm.communicator());
+  checkStatus(MPI_Iallreduce(MPI_IN_PLACE, buffer, static_cast<int>(count),
+                             toMpiDatatype(type), toMpiOp(op), mpiComm, &impl_->request),
+              "MPI_Iallreduce");
+}
+
+AsyncReductionRequest::AsyncReductionRequest(AsyncReductionRequest &&other) = default;
+
+AsyncReductionRequest::~AsyncReductionRequest() {
+  if (impl_ && impl_->request != MPI_REQUEST_NULL)
+    MPI_Wait(&impl_->request, MPI_STATUS_IGNORE);
+}
+
+bool AsyncReductionRequest::test() {
+  if (!impl_)
+    return true;
+  int flag = 0;
+  checkStatus(MPI_Test(&impl_->request, &flag, MPI_STATUS_IGNORE), "MPI_Test");
+  if (flag != 0)
+    impl_.reset();
+  return flag != 0;
+}
+
+void AsyncReductionRequest::wait() {
+  if (!impl_)
+    return;
+  checkStatus(MPI_Wait(&impl_->request, MPI_STATUS_IGNORE), "MPI_Wait");
+  impl_.reset();
+}
+
+}  // namespace detail
+}  // namespace ioda
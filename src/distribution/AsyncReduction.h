@@ -0,0 +1,159 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef DISTRIBUTION_ASYNCREDUCTION_H_
+#define DISTRIBUTION_ASYNCREDUCTION_H_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/mpi/Comm.h"
+#include "eckit/mpi/DataType.h"
+#include "eckit/mpi/Operation.h"
+#include "ioda/distribution/Accumulator.h"
+#include "ioda/distribution/Distribution.h"
+
+namespace ioda {
+
+namespace detail {
+
+/// \brief Request of a global reduction performed in place on a contiguous buffer.
+///
+/// This is the type-independent part of AsyncReduction; it hides the MPI calls behind the
+/// eckit communicator interface.
+class AsyncReductionRequest {
+ public:
+  /// \brief Start reducing the `count` elements of type `type` stored in `buffer` over all
+  /// processes of `comm`.
+  ///
+  /// The buffer must stay at the same address until the reduction completes.
+  AsyncReductionRequest(const eckit::mpi::Comm &comm, void *buffer, std::size_t count,
+                        eckit::mpi::Data::Code type, eckit::mpi::Operation::Code op);
+  AsyncReductionRequest(AsyncReductionRequest &&other);
+  ~AsyncReductionRequest();
+
+  AsyncReductionRequest(const AsyncReductionRequest &) = delete;
+  AsyncReductionRequest &operator=(const AsyncReductionRequest &) = delete;
+  AsyncReductionRequest &operator=(AsyncReductionRequest &&) = delete;
+
+  /// \brief Return true if the reduction has completed.
+  bool test();
+
+  /// \brief Wait for the reduction to complete.
+  void wait();
+
+ private:
+  class Impl;
+  /// Null if there is nothing left to wait for.
+  std::unique_ptr<Impl> impl_;
+};
+
+/// \brief Conversions between the result type of a reduction and the packed buffer sent to MPI.
+template <typename T>
+struct AsyncReductionTraits {
+  typedef T Element;
+  static std::vector<T> pack(const T &x) { return std::vector<T>(1, x); }
+  static T unpack(std::vector<T> &&buffer) { return buffer[0]; }
+};
+
+template <typename T>
+struct AsyncReductionTraits<std::vector<T>> {
+  typedef T Element;
+  static std::vector<T> pack(const std::vector<T> &x) { return x; }
+  static std::vector<T> unpack(std::vector<T> &&buffer) { return std::move(buffer); }
+};
+
+}  // namespace detail
+
+// ---------------------------------------------------------------------
+/*!
+ * \brief Handle to a global reduction running in the background.
+ *
+ * \details Objects of this class are returned by startSum(), startMin() and startMax(). The
+ *          reduction is started with a non-blocking allreduce when the object is created, so the
+ *          caller can do local work (e.g. compute H(x) for the next variable) while the data
+ *          travel through the network, and retrieve the result later with get().
+ *
+ *          All processes must start the same reductions in the same order. If a handle is
+ *          destroyed before get() is called, its destructor waits for the reduction to finish.
+ *
+ *          `T` can be int, std::size_t, float, double or a std::vector of one of these types.
+ */
+template <typename T>
+class AsyncReduction {
+  typedef detail::AsyncReductionTraits<T> Traits;
+  typedef typename Traits::Element Element;
+
+ public:
+  AsyncReduction(const eckit::mpi::Comm &comm, const T &localValue,
+                 eckit::mpi::Operation::Code op)
+    : buffer_(Traits::pack(localValue)),
+      request_(comm, buffer_.data(), buffer_.size(),
+               eckit::mpi::Data::Type<Element>::code(), op) {}
+
+  // Moving the buffer keeps its elements at the same address, so the pending reduction is
+  // unaffected.
+  AsyncReduction(AsyncReduction &&other) = default;
+
+  AsyncReduction(const AsyncReduction &) = delete;
+  AsyncReduction &operator=(const AsyncReduction &) = delete;
+  AsyncReduction &operator=(AsyncReduction &&) = delete;
+
+  /// \brief Return true if the reduction has completed (get() will then not block).
+  bool ready() { return request_.test(); }
+
+  /// \brief Wait for the reduction to complete and return its result.
+  ///
+  /// Can only be called once.
+  T get() {
+    ASSERT(!retrieved_);
+    request_.wait();
+    retrieved_ = true;
+    return Traits::unpack(std::move(buffer_));
+  }
+
+ private:
+  std::vector<Element> buffer_;
+  detail::AsyncReductionRequest request_;
+  bool retrieved_ = false;
+};
+
+// -----------------------------------------------------------------------------
+/// \brief Start computing the value that would be returned by `accumulator.computeResult()`.
+///
+/// Works with the accumulators of all distributions, since it only relies on
+/// Accumulator::computeLocalContribution(). The accumulator does not need to outlive this call.
+///
+/// \relates Distribution
+template <typename T>
+AsyncReduction<T> startSum(const Distribution &dist, const Accumulator<T> &accumulator) {
+  return AsyncReduction<T>(dist.comm(), accumulator.computeLocalContribution(),
+                           eckit::mpi::sum());
+}
+
+/// \brief Start computing the minimum of `x` over all processes (see Distribution::min()).
+///
+/// \relates Distribution
+template <typename T>
+AsyncReduction<T> startMin(const Distribution &dist, const T &x) {
+  return AsyncReduction<T>(dist.comm(), x, eckit::mpi::min());
+}
+
+/// \brief Start computing the maximum of `x` over all processes (see Distribution::max()).
+///
+/// \relates Distribution
+template <typename T>
+AsyncReduction<T> startMax(const Distribution &dist, const T &x) {
+  return AsyncReduction<T>(dist.comm(), x, eckit::mpi::max());
+}
+
+}  // namespace ioda
+
+#endif  // DISTRIBUTION_ASYNCREDUCTION_H_
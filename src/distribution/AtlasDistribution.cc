@@ -5,8 +5,16 @@
  * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
  */
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
-#include <unordered_set>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/make_unique.hpp>
 
@@ -18,18 +26,88 @@
 #include "eckit/mpi/Comm.h"
 #include "ioda/distribution/AtlasDistribution.h"
 #include "ioda/distribution/DistributionFactory.h"
+#include "ioda/distribution/HilbertDistribution.h"
+#include "ioda/distribution/RecordSet.h"
 #include "oops/util/Logger.h"
 
 namespace ioda {
 
 // -----------------------------------------------------------------------------
 
+namespace {
+
+/// \brief The Atlas mesh partitioned across processes and a locator of its partitions.
+struct PartitionLocator {
+  atlas::Mesh mesh;
+  std::unique_ptr<atlas::util::PolygonLocator> locator;
+};
+
+/// Constructs an Atlas grid and mesh using settings loaded from the `grid` section
+/// of `params`; then partitions the mesh across processes making up the `atlas::mpi::Comm()`
+/// communicator.
+///
+/// Building the mesh and its partition polygons is expensive, so the result is shared by all
+/// AtlasDistributions created with the same grid settings on a communicator of the same size
+/// (typically for multiple ObsSpaces in the same executable). The cache only holds weak
+/// references: the mesh is released when the last distribution using it is destroyed. This
+/// function may be called concurrently from several threads.
+std::shared_ptr<const PartitionLocator> getPartitionLocator(
+    const AtlasDistributionParameters & params) {
+  static std::mutex cacheMutex;
+  static std::map<std::string, std::weak_ptr<const PartitionLocator>> cache;
+
+  eckit::LocalConfiguration gridConfig = params.grid;
+  std::stringstream key;
+  key << atlas::mpi::comm().size() << ":" << gridConfig;
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  // Forget the meshes no longer used by any distribution.
+  for (auto it = cache.begin(); it != cache.end();) {
+    if (it->second.expired())
+      it = cache.erase(it);
+    else
+      ++it;
+  }
+  auto it = cache.find(key.str());
+  if (it != cache.end()) {
+    if (std::shared_ptr<const PartitionLocator> cached = it->second.lock()) {
+      oops::Log::debug() << "AtlasDistribution: reusing cached partition locator" << std::endl;
+      return cached;
+    }
+  }
+
+  atlas::util::Config atlasConfig(gridConfig);
+
+  atlas::Grid grid(atlasConfig);
+
+  atlasConfig.set("type", grid.meshgenerator().getString("type"));
+  atlas::MeshGenerator generator(atlasConfig);
+
+  auto partitionLocator = std::make_shared<PartitionLocator>();
+  partitionLocator->mesh = generator.generate(grid);
+  const atlas::Mesh & mesh = partitionLocator->mesh;
+  if (mesh->nb_partitions() != atlas::mpi::comm().size()) {
+    std::stringstream msg;
+    msg << "The number of mesh partitions, " << mesh->nb_partitions()
+        << ", is different from the number of MPI processes, " << atlas::mpi::comm().size();
+    throw eckit::Exception(msg.str(), Here());
+  }
+
+  partitionLocator->locator = boost::make_unique<atlas::util::PolygonLocator>(
+        atlas::util::ListPolygonXY(mesh.polygons()), mesh.projection());
+
+  cache[key.str()] = partitionLocator;
+  return partitionLocator;
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+
 /// \brief Assigns records to MPI ranks for the AtlasDistribution.
 class AtlasDistribution::RecordAssigner {
  public:
-  /// Constructs an Atlas grid and mesh using settings loaded from the `grid` section
-  /// of `config`; then partitions the mesh across processes making up the `atlas::mpi::Comm()`
-  /// communicator.
+  /// Retrieves the partitioned Atlas mesh described by the `grid` section of `params`.
   explicit RecordAssigner(const Parameters_ & params);
 
   /// If this record hasn't been assigned to any process yet, assigns it to the process
@@ -38,6 +116,14 @@ class AtlasDistribution::RecordAssigner {
   /// It is assumed that records will be assigned in consecutive order.
   void assignRecord(std::size_t recNum, const eckit::geometry::Point2 & point);
 
+  /// Assigns each record not assigned yet to the process owning the partition containing the
+  /// first of the `points` belonging to that record.
+  ///
+  /// The points are located in the order of their positions along a space-filling curve, so that
+  /// consecutive lookups visit nearby partition polygons.
+  void assignRecords(const std::vector<std::size_t> & recNums,
+                     const std::vector<eckit::geometry::Point2> & points);
+
   /// Returns true if record `recNum` has been assigned to the calling process, false otherwise.
   bool isMyRecord(std::size_t recNum) const;
 
@@ -45,34 +131,15 @@ class AtlasDistribution::RecordAssigner {
   bool isInMyDomain(const eckit::geometry::Point2 & point) const;
 
  private:
-  atlas::Mesh mesh_;
-  std::unique_ptr<atlas::util::PolygonLocator> locator_;
+  std::shared_ptr<const PartitionLocator> partitionLocator_;
 
-  std::unordered_set<std::size_t> myRecords_;
+  RecordSet myRecords_;
   std::size_t nextRecordToAssign_ = 0;
 };
 
 AtlasDistribution::RecordAssigner::RecordAssigner(const Parameters_ & params)
-{
-  eckit::LocalConfiguration gridConfig = params.grid;
-  atlas::util::Config atlasConfig(gridConfig);
-
-  atlas::Grid grid(atlasConfig);
-
-  atlasConfig.set("type", grid.meshgenerator().getString("type"));
-  atlas::MeshGenerator generator(atlasConfig);
-
-  mesh_ = generator.generate(grid);
-  if (mesh_->nb_partitions() != atlas::mpi::comm().size()) {
-    std::stringstream msg;
-    msg << "The number of mesh partitions, " << mesh_->nb_partitions()
-        << ", is different from the number of MPI processes, " << atlas::mpi::comm().size();
-    throw eckit::Exception(msg.str(), Here());
-  }
-
-  locator_ = boost::make_unique<atlas::util::PolygonLocator>(
-        atlas::util::ListPolygonXY(mesh_.polygons()), mesh_.projection());
-}
+  : partitionLocator_(getPartitionLocator(params))
+{}
 
 void AtlasDistribution::RecordAssigner::assignRecord(std::size_t recNum,
                                                      const eckit::geometry::Point2 & point) {
@@ -89,14 +156,41 @@ void AtlasDistribution::RecordAssigner::assignRecord(std::size_t recNum,
   }
 }
 
+void AtlasDistribution::RecordAssigner::assignRecords(
+    const std::vector<std::size_t> & recNums,
+    const std::vector<eckit::geometry::Point2> & points) {
+  // Find the first location of each record that hasn't been assigned yet.
+  std::vector<std::pair<std::uint64_t, std::size_t>> newRecordLocs;
+  for (std::size_t i = 0; i < recNums.size(); ++i) {
+    if (recNums[i] == nextRecordToAssign_) {
+      newRecordLocs.push_back(std::make_pair(HilbertDistribution::hilbertIndex(points[i]), i));
+      ++nextRecordToAssign_;
+    } else {
+      // We assume records will be assigned in consecutive order
+      ASSERT(recNums[i] < nextRecordToAssign_);
+    }
+  }
+
+  // Sort these locations into spatially coherent order and locate them.
+  std::sort(newRecordLocs.begin(), newRecordLocs.end());
+  std::size_t numMyNewRecords = 0;
+  for (const auto & bucketAndLoc : newRecordLocs) {
+    if (isInMyDomain(points[bucketAndLoc.second])) {
+      myRecords_.insert(recNums[bucketAndLoc.second]);
+      ++numMyNewRecords;
+    }
+  }
+  oops::Log::debug() << "RecordAssigner::assignRecords(): " << numMyNewRecords << " of "
+                     << newRecordLocs.size() << " new records assigned to this process"
+                     << std::endl;
+}
+
 bool AtlasDistribution::RecordAssigner::isMyRecord(std::size_t recNum) const {
-  return myRecords_.find(recNum) != myRecords_.end();
+  return myRecords_.contains(recNum);
 }
 
 bool AtlasDistribution::RecordAssigner::isInMyDomain(const eckit::geometry::Point2 & point) const {
-  const atlas::idx_t partition = (*locator_)(point);
-  oops::Log::debug() << "RecordAssigner::isInMyDomain(): Polygon locator says "
-                     << point << " is in domain " << partition << std::endl;
+  const atlas::idx_t partition = (*partitionLocator_->locator)(point);
   return partition == atlas::mpi::comm().rank();
 }
 
@@ -123,6 +217,16 @@ void AtlasDistribution::assignRecord(const std::size_t recNum,
   NonoverlappingDistribution::assignRecord(recNum, locNum, point);
 }
 
+void AtlasDistribution::assignRecords(const std::vector<std::size_t> & recNums,
+                                      const std::vector<std::size_t> & locNums,
+                                      const std::vector<eckit::geometry::Point2> & points) {
+  ASSERT(recNums.size() == locNums.size());
+  ASSERT(recNums.size() == points.size());
+  recordAssigner_->assignRecords(recNums, points);
+  for (std::size_t i = 0; i < recNums.size(); ++i)
+    NonoverlappingDistribution::assignRecord(recNums[i], locNums[i], points[i]);
+}
+
 bool AtlasDistribution::isMyRecord(std::size_t RecNum) const {
   return recordAssigner_->isMyRecord(RecNum);
 }
@@ -9,6 +9,7 @@
 #define DISTRIBUTION_ATLASDISTRIBUTION_H_
 
 #include <memory>
+#include <vector>
 
 #include "ioda/distribution/DistributionParametersBase.h"
 #include "ioda/distribution/NonoverlappingDistribution.h"
@@ -33,7 +34,8 @@ class AtlasDistributionParameters : public DistributionParametersBase {
 /// containing the location of the first observation in that record.
 ///
 /// The Atlas grid and mesh is created and partitioned using settings taken from the `grid` section
-/// of the Configuration passed to the constructor.
+/// of the Configuration passed to the constructor. The partitioned mesh is shared by all
+/// AtlasDistributions created with the same settings.
 class AtlasDistribution: public NonoverlappingDistribution {
  public:
     typedef AtlasDistributionParameters Parameters_;
@@ -43,6 +45,9 @@ class AtlasDistribution: public NonoverlappingDistribution {
 
     void assignRecord(const std::size_t recNum, const std::size_t locNum,
                       const eckit::geometry::Point2 & point) override;
+    void assignRecords(const std::vector<std::size_t> & recNums,
+                       const std::vector<std::size_t> & locNums,
+                       const std::vector<eckit::geometry::Point2> & points) override;
 
     bool isMyRecord(std::size_t recNum) const override;
 
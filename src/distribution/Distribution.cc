@@ -26,4 +26,15 @@ Distribution::~Distribution() {
   oops::Log::trace() << "Distribtion destructed" << std::endl;
 }
 
+// -----------------------------------------------------------------------------
+
+void Distribution::assignRecords(const std::vector<std::size_t> & RecNums,
+                                 const std::vector<std::size_t> & LocNums,
+                                 const std::vector<eckit::geometry::Point2> & points) {
+  ASSERT(RecNums.size() == LocNums.size());
+  ASSERT(RecNums.size() == points.size());
+  for (std::size_t i = 0; i < RecNums.size(); ++i)
+    assignRecord(RecNums[i], LocNums[i], points[i]);
+}
+
 }  // namespace ioda
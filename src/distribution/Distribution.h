@@ -80,6 +80,21 @@ class Distribution {
     virtual void assignRecord(const std::size_t RecNum, const std::size_t LocNum,
                               const eckit::geometry::Point2 & point) {}
 
+    /*!
+     * \brief Assigns a batch of locations (typically all locations from a single frame) to
+     * records, with the same effect as calling assignRecord() for each of them in turn.
+     *
+     * Distributions that can make better decisions when they see many records at once
+     * (for example to balance the number of locations per PE) override this function.
+     *
+     * \param RecNums Records containing the locations \p LocNums.
+     * \param LocNums (Global) location indices, in increasing order.
+     * \param points Latitude and longitude of each location.
+     */
+    virtual void assignRecords(const std::vector<std::size_t> & RecNums,
+                               const std::vector<std::size_t> & LocNums,
+                               const std::vector<eckit::geometry::Point2> & points);
+
     /*!
      * \brief Returns true if record \p RecNum has been assigned to the calling PE during a
      * previous call to assignRecord().
@@ -227,6 +242,9 @@ class Distribution {
     /// Accessor to MPI rank
     size_t rank() const {return comm_.rank();}
 
+    /// Accessor to the MPI communicator
+    const eckit::mpi::Comm & comm() const {return comm_;}
+
  private:
   /*!
    * \brief Create an object that can be used to calculate the sum of a location-dependent
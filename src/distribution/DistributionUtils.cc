@@ -5,14 +5,21 @@
  * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
  */
 
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
 #include "ioda/distribution/Accumulator.h"
 #include "ioda/distribution/Distribution.h"
 #include "ioda/distribution/DistributionParametersBase.h"
 #include "ioda/distribution/DistributionUtils.h"
 #include "ioda/distribution/InefficientDistribution.h"
+#include "ioda/distribution/ReductionBatch.h"
 #include "ioda/distribution/ReplicaOfNonoverlappingDistribution.h"
 #include "ioda/distribution/ReplicaOfGeneralDistribution.h"
 
+#include "eckit/mpi/Comm.h"
+#include "oops/mpi/mpi.h"
 #include "oops/util/DateTime.h"
 #include "oops/util/missingValues.h"
 
@@ -20,13 +27,13 @@ namespace ioda {
 
 namespace {
 
+/// Returns an accumulator holding the local contributions to the number of non-missing obs.
 template <typename T>
-std::size_t globalNumNonMissingObsImpl(const Distribution &dist,
-                                       std::size_t numVariables, const std::vector<T> &v) {
+std::unique_ptr<Accumulator<std::size_t>> accumulateNumNonMissingObs(
+    const Distribution &dist, std::size_t numVariables, const std::vector<T> &v) {
   const T missingValue = util::missingValue(missingValue);
   const std::size_t numLocations = v.size() / numVariables;
 
-  // Local reduction
   std::unique_ptr<Accumulator<std::size_t>> accumulator = dist.createAccumulator<std::size_t>();
   for (size_t loc = 0, element = 0; loc < numLocations; ++loc) {
     std::size_t term = 0;
@@ -35,20 +42,47 @@ std::size_t globalNumNonMissingObsImpl(const Distribution &dist,
         ++term;
     accumulator->addTerm(loc, term);
   }
+  return accumulator;
+}
+
+std::unique_ptr<Accumulator<std::size_t>> accumulateNumNonMissingObs(
+    const Distribution &dist, std::size_t numVariables, const std::vector<bool> &v) {
+  const std::size_t numLocations = v.size() / numVariables;
+
+  std::unique_ptr<Accumulator<std::size_t>> accumulator = dist.createAccumulator<std::size_t>();
+  for (size_t loc = 0; loc < numLocations; ++loc)
+    accumulator->addTerm(loc, numVariables);
+  return accumulator;
+}
+
+template <typename T>
+std::size_t globalNumNonMissingObsImpl(const Distribution &dist,
+                                       std::size_t numVariables, const std::vector<T> &v) {
+  // Local reduction
+  std::unique_ptr<Accumulator<std::size_t>> accumulator =
+      accumulateNumNonMissingObs(dist, numVariables, v);
   // Global reduction
   return accumulator->computeResult();
 }
 
 template <typename T>
-double dotProductImpl(const Distribution &dist,
-                      std::size_t numVariables,
-                      const std::vector<T> &v1,
-                      const std::vector<T> &v2) {
+void globalNumNonMissingObsImpl(ReductionBatch &batch, const Distribution &dist,
+                                std::size_t numVariables, const std::vector<T> &v,
+                                std::size_t &result) {
+  // Local reduction; the global reduction is deferred to batch.execute()
+  batch.sum(*accumulateNumNonMissingObs(dist, numVariables, v), result);
+}
+
+/// Returns an accumulator holding the local contributions to the dot product of two vectors.
+template <typename T>
+std::unique_ptr<Accumulator<double>> accumulateDotProduct(const Distribution &dist,
+                                                          std::size_t numVariables,
+                                                          const std::vector<T> &v1,
+                                                          const std::vector<T> &v2) {
   ASSERT(v1.size() == v2.size());
   const T missingValue = util::missingValue(missingValue);
   const std::size_t numLocations = v1.size() / numVariables;
 
-  // Local reduction
   std::unique_ptr<Accumulator<double>> accumulator = dist.createAccumulator<double>();
   for (size_t loc = 0, element = 0; loc < numLocations; ++loc) {
     double term = 0;
@@ -57,10 +91,30 @@ double dotProductImpl(const Distribution &dist,
         term += v1[element] * v2[element];
     accumulator->addTerm(loc, term);
   }
+  return accumulator;
+}
+
+template <typename T>
+double dotProductImpl(const Distribution &dist,
+                      std::size_t numVariables,
+                      const std::vector<T> &v1,
+                      const std::vector<T> &v2) {
+  // Local reduction
+  std::unique_ptr<Accumulator<double>> accumulator =
+      accumulateDotProduct(dist, numVariables, v1, v2);
   // Global reduction
   return accumulator->computeResult();
 }
 
+template <typename T>
+void dotProductImpl(ReductionBatch &batch, const Distribution &dist,
+                    std::size_t numVariables,
+                    const std::vector<T> &v1, const std::vector<T> &v2,
+                    double &result) {
+  // Local reduction; the global reduction is deferred to batch.execute()
+  batch.sum(*accumulateDotProduct(dist, numVariables, v1, v2), result);
+}
+
 }  // namespace
 
 // -----------------------------------------------------------------------------
@@ -126,15 +180,138 @@ std::size_t globalNumNonMissingObs(const Distribution &dist,
 std::size_t globalNumNonMissingObs(const Distribution &dist,
                                    std::size_t numVariables,
                                    const std::vector<bool> &v) {
-  const std::size_t numLocations = v.size() / numVariables;
+  return globalNumNonMissingObsImpl(dist, numVariables, v);
+}
 
-  // Local reduction
-  std::unique_ptr<Accumulator<std::size_t>> accumulator = dist.createAccumulator<std::size_t>();
-  for (size_t loc = 0; loc < numLocations; ++loc)
-    accumulator->addTerm(loc, numVariables);
+// -----------------------------------------------------------------------------
+void dotProduct(ReductionBatch &batch, const Distribution &dist,
+                std::size_t numVariables,
+                const std::vector<double> &v1, const std::vector<double> &v2,
+                double &result) {
+  dotProductImpl(batch, dist, numVariables, v1, v2, result);
+}
 
-  // Global reduction
-  return accumulator->computeResult();
+void dotProduct(ReductionBatch &batch, const Distribution &dist,
+                std::size_t numVariables,
+                const std::vector<float> &v1, const std::vector<float> &v2,
+                double &result) {
+  dotProductImpl(batch, dist, numVariables, v1, v2, result);
+}
+
+void dotProduct(ReductionBatch &batch, const Distribution &dist,
+                std::size_t numVariables,
+                const std::vector<int> &v1, const std::vector<int> &v2,
+                double &result) {
+  dotProductImpl(batch, dist, numVariables, v1, v2, result);
+}
+
+void dotProduct(ReductionBatch &batch, const Distribution &dist,
+                std::size_t numVariables,
+                const std::vector<int64_t> &v1, const std::vector<int64_t> &v2,
+                double &result) {
+  dotProductImpl(batch, dist, numVariables, v1, v2, result);
+}
+
+// -----------------------------------------------------------------------------
+void globalNumNonMissingObs(ReductionBatch &batch, const Distribution &dist,
+                            std::size_t numVariables, const std::vector<double> &v,
+                            std::size_t &result) {
+  globalNumNonMissingObsImpl(batch, dist, numVariables, v, result);
+}
+
+void globalNumNonMissingObs(ReductionBatch &batch, const Distribution &dist,
+                            std::size_t numVariables, const std::vector<float> &v,
+                            std::size_t &result) {
+  globalNumNonMissingObsImpl(batch, dist, numVariables, v, result);
+}
+
+void globalNumNonMissingObs(ReductionBatch &batch, const Distribution &dist,
+                            std::size_t numVariables, const std::vector<int> &v,
+                            std::size_t &result) {
+  globalNumNonMissingObsImpl(batch, dist, numVariables, v, result);
+}
+
+void globalNumNonMissingObs(ReductionBatch &batch, const Distribution &dist,
+                            std::size_t numVariables, const std::vector<std::string> &v,
+                            std::size_t &result) {
+  globalNumNonMissingObsImpl(batch, dist, numVariables, v, result);
+}
+
+void globalNumNonMissingObs(ReductionBatch &batch, const Distribution &dist,
+                            std::size_t numVariables, const std::vector<util::DateTime> &v,
+                            std::size_t &result) {
+  globalNumNonMissingObsImpl(batch, dist, numVariables, v, result);
+}
+
+void globalNumNonMissingObs(ReductionBatch &batch, const Distribution &dist,
+                            std::size_t numVariables, const std::vector<bool> &v,
+                            std::size_t &result) {
+  globalNumNonMissingObsImpl(batch, dist, numVariables, v, result);
+}
+
+// -----------------------------------------------------------------------------
+std::vector<int> rebalanceRecords(const eckit::mpi::Comm & comm,
+                                  const std::vector<std::size_t> &recordWeights) {
+  const std::size_t nranks = comm.size();
+  const int myRank = comm.rank();
+  std::vector<int> destinations(recordWeights.size(), myRank);
+
+  std::size_t myWeight = std::accumulate(recordWeights.begin(), recordWeights.end(),
+                                         static_cast<std::size_t>(0));
+  std::vector<std::size_t> weights(nranks);
+  comm.allGather(myWeight, weights.begin(), weights.end());
+  const std::size_t totalWeight = std::accumulate(weights.begin(), weights.end(),
+                                                  static_cast<std::size_t>(0));
+  const std::size_t targetWeight = (totalWeight + nranks - 1) / nranks;
+
+  // Step 1: overloaded processes give away records, heaviest first, as long as this does not
+  // take them below the target weight.
+  std::vector<std::size_t> order(recordWeights.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&recordWeights](std::size_t a, std::size_t b)
+                   { return recordWeights[a] > recordWeights[b]; });
+  std::vector<std::size_t> surplusRecords;
+  std::vector<std::size_t> surplusWeights;
+  for (std::size_t rec : order) {
+    const std::size_t w = recordWeights[rec];
+    if (w == 0 || myWeight <= targetWeight)
+      break;
+    if (myWeight - w >= targetWeight) {
+      myWeight -= w;
+      surplusRecords.push_back(rec);
+      surplusWeights.push_back(w);
+    }
+  }
+
+  // Step 2: every process learns the weights of all surplus records and the weights remaining
+  // on each process, and assigns the surplus records with the longest-processing-time rule.
+  // All processes perform the same computation, so no further communication is needed.
+  comm.allGather(myWeight, weights.begin(), weights.end());
+  std::vector<std::size_t> numSurplusRecords(nranks);
+  comm.allGather(surplusWeights.size(), numSurplusRecords.begin(), numSurplusRecords.end());
+  std::vector<std::size_t> allSurplusWeights = surplusWeights;
+  oops::mpi::allGatherv(comm, allSurplusWeights);
+
+  // Tuples (weight, source rank, index in the source rank's list of surplus records)
+  std::vector<std::tuple<std::size_t, int, std::size_t>> surplus;
+  surplus.reserve(allSurplusWeights.size());
+  for (std::size_t rank = 0, i = 0; rank < nranks; ++rank)
+    for (std::size_t j = 0; j < numSurplusRecords[rank]; ++j, ++i)
+      surplus.emplace_back(allSurplusWeights[i], rank, j);
+  std::stable_sort(surplus.begin(), surplus.end(),
+                   [](const std::tuple<std::size_t, int, std::size_t> &a,
+                      const std::tuple<std::size_t, int, std::size_t> &b)
+                   { return std::get<0>(a) > std::get<0>(b); });
+
+  for (const auto &record : surplus) {
+    // Ties are resolved in favour of the lowest rank, so all PEs make the same choice.
+    const int rank = std::min_element(weights.begin(), weights.end()) - weights.begin();
+    weights[rank] += std::get<0>(record);
+    if (std::get<1>(record) == myRank)
+      destinations[surplusRecords[std::get<2>(record)]] = rank;
+  }
+
+  return destinations;
 }
 
 // -----------------------------------------------------------------------------
@@ -25,6 +25,7 @@ class DateTime;
 namespace ioda {
 
 class Distribution;
+class ReductionBatch;
 
 /// \brief Computes the dot product between two vectors of obs distributed across MPI ranks.
 ///
@@ -51,6 +52,21 @@ double dotProduct(const Distribution &dist, std::size_t numVariables,
 double dotProduct(const Distribution &dist, std::size_t numVariables,
                   const std::vector<int64_t> &v1, const std::vector<int64_t> &v2);
 
+/// \brief Adds the computation of the dot product between two vectors of obs distributed across
+/// MPI ranks to a batch of reductions.
+///
+/// The dot product (see above) is stored in `result` when `batch.execute()` is called.
+///
+/// \relates Distribution
+void dotProduct(ReductionBatch &batch, const Distribution &dist, std::size_t numVariables,
+                const std::vector<double> &v1, const std::vector<double> &v2, double &result);
+void dotProduct(ReductionBatch &batch, const Distribution &dist, std::size_t numVariables,
+                const std::vector<float> &v1, const std::vector<float> &v2, double &result);
+void dotProduct(ReductionBatch &batch, const Distribution &dist, std::size_t numVariables,
+                const std::vector<int> &v1, const std::vector<int> &v2, double &result);
+void dotProduct(ReductionBatch &batch, const Distribution &dist, std::size_t numVariables,
+                const std::vector<int64_t> &v1, const std::vector<int64_t> &v2, double &result);
+
 /// \brief Counts unique non-missing observations in a vector.
 ///
 /// \param distribution
@@ -80,6 +96,47 @@ std::size_t globalNumNonMissingObs(const Distribution &dist,
 std::size_t globalNumNonMissingObs(const Distribution &dist,
                                    size_t numVariables, const std::vector<bool> &v);
 
+/// \brief Adds the count of unique non-missing observations in a vector to a batch of reductions.
+///
+/// The count (see above) is stored in `result` when `batch.execute()` is called.
+///
+/// \relates Distribution
+void globalNumNonMissingObs(ReductionBatch &batch, const Distribution &dist,
+                            size_t numVariables, const std::vector<double> &v,
+                            std::size_t &result);
+void globalNumNonMissingObs(ReductionBatch &batch, const Distribution &dist,
+                            size_t numVariables, const std::vector<float> &v,
+                            std::size_t &result);
+void globalNumNonMissingObs(ReductionBatch &batch, const Distribution &dist,
+                            size_t numVariables, const std::vector<int> &v,
+                            std::size_t &result);
+void globalNumNonMissingObs(ReductionBatch &batch, const Distribution &dist,
+                            size_t numVariables, const std::vector<std::string> &v,
+                            std::size_t &result);
+void globalNumNonMissingObs(ReductionBatch &batch, const Distribution &dist,
+                            size_t numVariables, const std::vector<util::DateTime> &v,
+                            std::size_t &result);
+void globalNumNonMissingObs(ReductionBatch &batch, const Distribution &dist,
+                            size_t numVariables, const std::vector<bool> &v,
+                            std::size_t &result);
+
+/// \brief Choose the processes to which records should be moved to balance the total weight
+/// of records held by each process.
+///
+/// Only records held by processes whose total weight exceeds the average are moved, and records
+/// of zero weight are never moved. The surplus weights of all processes are allgathered, so all
+/// processes make consistent decisions; each process gets the destinations of its own records.
+///
+/// \param comm
+///   Communicator.
+/// \param recordWeights
+///   Weights (e.g. numbers of active locations) of the records held by the calling process.
+///
+/// \return A vector of the same length as `recordWeights` containing the rank of the process
+/// that should hold each record of the calling process.
+std::vector<int> rebalanceRecords(const eckit::mpi::Comm & comm,
+                                  const std::vector<std::size_t> &recordWeights);
+
 /// \brief Create a suitable replica distribution for the distribution `master`.
 ///
 /// A replica distribution assigns each record `r` to a process if and only if another distribution
@@ -37,6 +37,10 @@ class GeneralDistributionAccumulator : public Accumulator<T> {
     return result;
   }
 
+  T computeLocalContribution() const override {
+    return localResult_;
+  }
+
  private:
   T localResult_;
   const eckit::mpi::Comm &comm_;
@@ -74,6 +78,10 @@ class GeneralDistributionAccumulator<std::vector<T>> : public Accumulator<std::v
     return result;
   }
 
+  std::vector<T> computeLocalContribution() const override {
+    return localResult_;
+  }
+
  private:
   std::vector<T> localResult_;
   const eckit::mpi::Comm &comm_;
@@ -28,6 +28,23 @@ namespace ioda {
 // -----------------------------------------------------------------------------
 static DistributionMaker<Halo> maker("Halo");
 
+constexpr std::size_t Halo::noRecord;
+
+namespace {
+
+// Tags of messages exchanged between neighbouring PEs in Halo::computePatchLocs().
+constexpr int recordCountTag = 4101;
+constexpr int recordNumbersTag = 4102;
+constexpr int recordDistancesTag = 4103;
+constexpr int patchIndicesTag = 4104;
+
+// Safety margin [m] used when deciding whether a point may lie in the halo of another PE.
+// Sending a few records that turn out not to be held by the receiver is harmless, but failing
+// to send a record that is held there would lead to its duplication in the patch obs.
+constexpr double distanceTolerance = 1.0;
+
+}  // namespace
+
 // -----------------------------------------------------------------------------
 /*!
  * \brief Halo selector
@@ -79,12 +96,12 @@ Halo::~Halo() {
 // -----------------------------------------------------------------------------
 void Halo::assignRecord(const std::size_t RecNum, const std::size_t LocNum,
                         const eckit::geometry::Point2 & point) {
-  if (recordsOutsideHalo_.find(RecNum) != recordsOutsideHalo_.end()) {
+  if (recordsOutsideHalo_.contains(RecNum)) {
     // We've already seen the first location in this record, and it was too far away from center_.
     return;
   }
 
-  if (recordsInHalo_.find(RecNum) == recordsInHalo_.end()) {
+  if (!recordsInHalo_.contains(RecNum)) {
     // This is the first location from this record. Find out whether to assign it to this PE.
 
     const double dist = eckit::geometry::Sphere::distance(radius_earth_, center_, point);
@@ -93,7 +110,7 @@ void Halo::assignRecord(const std::size_t RecNum, const std::size_t LocNum,
     if (dist <= radius_) {
       // Yes!
       recordsInHalo_.insert(RecNum);
-      recordDistancesFromCenter_[RecNum] = dist;
+      haloRecords_.push_back(HaloRecord{RecNum, dist, point});
     } else {
       // No, it's too far from center_.
       recordsOutsideHalo_.insert(RecNum);
@@ -108,124 +125,263 @@ void Halo::assignRecord(const std::size_t RecNum, const std::size_t LocNum,
 
 // -----------------------------------------------------------------------------
 bool Halo::isMyRecord(std::size_t RecNum) const {
-    return (recordsInHalo_.count(RecNum) > 0);
+    return recordsInHalo_.contains(RecNum);
+}
+
+// -----------------------------------------------------------------------------
+std::size_t Halo::findHaloRecord(std::size_t recNum) const {
+  if (!recordsInHalo_.contains(recNum))
+    return noRecord;
+  auto it = std::lower_bound(haloRecords_.begin(), haloRecords_.end(), recNum,
+                             [](const HaloRecord &record, std::size_t r)
+                             { return record.recNum < r; });
+  ASSERT(it != haloRecords_.end() && it->recNum == recNum);
+  return it - haloRecords_.begin();
+}
+
+// -----------------------------------------------------------------------------
+void Halo::findNeighbours(std::vector<int> &ranks,
+                          std::vector<eckit::geometry::Point2> &centers,
+                          std::vector<double> &radii) const {
+  const size_t nranks = comm_.size();
+  std::vector<double> allLons(nranks), allLats(nranks), allRadii(nranks);
+  comm_.allGather(center_[0], allLons.begin(), allLons.end());
+  comm_.allGather(center_[1], allLats.begin(), allLats.end());
+  comm_.allGather(radius_, allRadii.begin(), allRadii.end());
+
+  ranks.clear();
+  centers.clear();
+  radii.clear();
+  for (size_t rank = 0; rank < nranks; ++rank) {
+    if (rank == comm_.rank())
+      continue;
+    const eckit::geometry::Point2 center(allLons[rank], allLats[rank]);
+    const double dist = eckit::geometry::Sphere::distance(radius_earth_, center_, center);
+    if (dist <= radius_ + allRadii[rank] + distanceTolerance) {
+      ranks.push_back(rank);
+      centers.push_back(center);
+      radii.push_back(allRadii[rank]);
+    }
+  }
+  oops::Log::debug() << "Halo: number of neighbouring halos: " << ranks.size() << std::endl;
 }
 
 // -----------------------------------------------------------------------------
 void Halo::computePatchLocs() {
-  // define some constants for this PE
-  double inf = std::numeric_limits<double>::infinity();
-  size_t myRank = comm_.rank();
+  const int myRank = comm_.rank();
 
   // All records have now been assigned, so this container is no longer needed.
   recordsOutsideHalo_.clear();
 
-  // Find the maximum global location index (plus 1)
-  size_t nglocs = 0;
-  if (!haloLocVector_.empty())
-    nglocs = haloLocVector_.back() + 1;
-  comm_.allReduceInPlace(nglocs, eckit::mpi::max());
-
-  if ( nglocs > 0 ) {
-    // make structures holding pairs of {distance,rank} for reduce operation later
-    // initialize the local array to dist == inf
-    std::vector<std::pair<double, int>> dist_and_lidx_loc(nglocs);
-    std::vector<std::pair<double, int>> dist_and_lidx_glb(nglocs);
-    for ( size_t jj = 0; jj < nglocs; ++jj ) {
-      dist_and_lidx_loc[jj] = std::make_pair(inf, myRank);
+  // Records usually arrive in order of increasing record number, but make sure they are sorted
+  // so that they can be looked up by binary search.
+  auto byRecNum = [](const HaloRecord &a, const HaloRecord &b) { return a.recNum < b.recNum; };
+  if (!std::is_sorted(haloRecords_.begin(), haloRecords_.end(), byRecNum))
+    std::sort(haloRecords_.begin(), haloRecords_.end(), byRecNum);
+
+  // A record can only be held by ranks whose halos contain its first location, so the ownership
+  // of each record held on this PE only needs to be negotiated with the neighbouring halos.
+  std::vector<int> neighbours;
+  std::vector<eckit::geometry::Point2> neighbourCenters;
+  std::vector<double> neighbourRadii;
+  findNeighbours(neighbours, neighbourCenters, neighbourRadii);
+  const size_t nneighbours = neighbours.size();
+
+  // Step 1: send to each neighbour the numbers of records held on this PE that may also be held
+  // by that neighbour, together with their distances from the center of this PE's halo.
+  std::vector<std::vector<std::size_t>> sendRecNums(nneighbours);
+  std::vector<std::vector<double>> sendDists(nneighbours);
+  for (const HaloRecord & record : haloRecords_) {
+    for (size_t i = 0; i < nneighbours; ++i) {
+      const double dist = eckit::geometry::Sphere::distance(
+            radius_earth_, neighbourCenters[i], record.point);
+      if (dist <= neighbourRadii[i] + distanceTolerance) {
+        sendRecNums[i].push_back(record.recNum);
+        sendDists[i].push_back(record.distance);
+      }
     }
+  }
 
-    // assign actual distances to local obs (stored in haloLocVector_)
-    for (size_t loc = 0; loc < haloLocVector_.size(); ++loc) {
-      const size_t gloc = haloLocVector_[loc];
-      const size_t recNum = haloLocRecords_[loc];
-      const double dist = recordDistancesFromCenter_.at(recNum);
-      dist_and_lidx_loc[gloc] = std::make_pair(dist, myRank);
+  std::vector<std::size_t> sendCounts(nneighbours);
+  std::vector<std::size_t> recvCounts(nneighbours);
+  {
+    std::vector<eckit::mpi::Request> requests;
+    requests.reserve(2 * nneighbours);
+    for (size_t i = 0; i < nneighbours; ++i)
+      requests.push_back(comm_.iReceive(&recvCounts[i], 1, neighbours[i], recordCountTag));
+    for (size_t i = 0; i < nneighbours; ++i) {
+      sendCounts[i] = sendRecNums[i].size();
+      requests.push_back(comm_.iSend(&sendCounts[i], 1, neighbours[i], recordCountTag));
     }
+    comm_.waitAll(requests);
+  }
 
-    // use reduce operation to find PE rank with minimal distance
-    comm_.allReduce(dist_and_lidx_loc, dist_and_lidx_glb, eckit::mpi::minloc());
-
-    // ids of patch observations owned by this PE
-    std::unordered_set<std::size_t> patchObsLoc;
-
-    // if this PE has the minimum distance then this PE owns this ob. as patch
-    for (auto i : haloLocVector_) {
-      if ( dist_and_lidx_glb[i].second == myRank ) {
-        patchObsLoc.insert(i);
-      }
+  std::vector<std::vector<std::size_t>> recvRecNums(nneighbours);
+  std::vector<std::vector<double>> recvDists(nneighbours);
+  {
+    std::vector<eckit::mpi::Request> requests;
+    requests.reserve(4 * nneighbours);
+    for (size_t i = 0; i < nneighbours; ++i) {
+      recvRecNums[i].resize(recvCounts[i]);
+      recvDists[i].resize(recvCounts[i]);
+      requests.push_back(comm_.iReceive(recvRecNums[i].data(), recvCounts[i],
+                                        neighbours[i], recordNumbersTag));
+      requests.push_back(comm_.iReceive(recvDists[i].data(), recvCounts[i],
+                                        neighbours[i], recordDistancesTag));
     }
-
-    // convert storage from unodered sets to a bool vector
-    for (size_t jj = 0; jj < haloLocVector_.size(); ++jj) {
-      if ( patchObsLoc.count(haloLocVector_[jj]) ) {
-        patchObsBool_.push_back(true);
-      } else {
-        patchObsBool_.push_back(false);
+    for (size_t i = 0; i < nneighbours; ++i) {
+      requests.push_back(comm_.iSend(sendRecNums[i].data(), sendCounts[i],
+                                     neighbours[i], recordNumbersTag));
+      requests.push_back(comm_.iSend(sendDists[i].data(), sendCounts[i],
+                                     neighbours[i], recordDistancesTag));
+    }
+    comm_.waitAll(requests);
+  }
+  sendRecNums.clear();
+  sendDists.clear();
+
+  // Step 2: each record is owned by the PE whose halo center is closest to the record's first
+  // location (ties are resolved in favour of the PE with the lowest rank). Every PE holding
+  // a record receives the same set of candidates, so all of them reach the same verdict.
+  std::vector<std::pair<double, int>> recordOwners(haloRecords_.size());
+  for (size_t r = 0; r < haloRecords_.size(); ++r)
+    recordOwners[r] = std::make_pair(haloRecords_[r].distance, myRank);
+  std::vector<std::vector<std::size_t>> recvRecIndices(nneighbours);
+  for (size_t i = 0; i < nneighbours; ++i) {
+    recvRecIndices[i].resize(recvRecNums[i].size());
+    for (size_t j = 0; j < recvRecNums[i].size(); ++j) {
+      const std::size_t r = findHaloRecord(recvRecNums[i][j]);
+      recvRecIndices[i][j] = r;
+      if (r != noRecord) {
+        const std::pair<double, int> candidate(recvDists[i][j], neighbours[i]);
+        if (candidate < recordOwners[r])
+          recordOwners[r] = candidate;
       }
     }
+  }
+  recvRecNums.clear();
+  recvDists.clear();
 
-    size_t npatchobs = std::count(patchObsBool_.begin(), patchObsBool_.end(), true);
-    oops::Log::debug() << "npatchobs: " << npatchobs << std::endl;
-    oops::Log::debug() << "patchObsBool_.size(): " << patchObsBool_.size() << std::endl;
+  // Locations of the same record are usually adjacent, so reuse the last lookup if possible.
+  std::vector<std::size_t> locRecIndices(haloLocVector_.size());
+  for (size_t loc = 0; loc < haloLocVector_.size(); ++loc)
+    locRecIndices[loc] = (loc > 0 && haloLocRecords_[loc] == haloLocRecords_[loc - 1]) ?
+          locRecIndices[loc - 1] : findHaloRecord(haloLocRecords_[loc]);
 
-    // now that we have patchObsBool_ computed we can free memory occupied by some temp objects
-    recordDistancesFromCenter_.clear();
-    haloLocRecords_.clear();
-    haloLocRecords_.shrink_to_fit();
+  patchObsBool_.resize(haloLocVector_.size());
+  for (size_t loc = 0; loc < haloLocVector_.size(); ++loc)
+    patchObsBool_[loc] = (recordOwners[locRecIndices[loc]].second == myRank);
 
-    computeGlobalUniqueConsecutiveLocIndices(dist_and_lidx_glb);
+  size_t npatchobs = std::count(patchObsBool_.begin(), patchObsBool_.end(), true);
+  oops::Log::debug() << "npatchobs: " << npatchobs << std::endl;
+  oops::Log::debug() << "patchObsBool_.size(): " << patchObsBool_.size() << std::endl;
 
-    // and now the remaining temp object
-    haloLocVector_.clear();
-    haloLocVector_.shrink_to_fit();
-  }
+  // now that we have patchObsBool_ computed we can free memory occupied by some temp objects
+  haloRecords_.clear();
+  haloRecords_.shrink_to_fit();
+
+  computeGlobalUniqueConsecutiveLocIndices(neighbours, recvRecIndices, locRecIndices,
+                                           recordOwners);
+
+  // and now the remaining temp objects
+  haloLocRecords_.clear();
+  haloLocRecords_.shrink_to_fit();
+  haloLocVector_.clear();
+  haloLocVector_.shrink_to_fit();
 }
 
 // -----------------------------------------------------------------------------
 void Halo::computeGlobalUniqueConsecutiveLocIndices(
-    const std::vector<std::pair<double, int>> &dist_and_lidx_glb) {
-  const double inf = std::numeric_limits<double>::infinity();
-
-  globalUniqueConsecutiveLocIndices_.reserve(haloLocVector_.size());
-
-  // Step 0: enable quick checks of whether a location belongs to this rank's halo.
-  std::unordered_set<size_t> haloLocSet(haloLocVector_.begin(), haloLocVector_.end());
-
-  // Step 1: index patch observations owned by each rank consecutively (starting from 0 on each
-  // rank). For each observation i held on this rank, set globalConsecutiveLocIndices_[i] to
-  // the index of the corresponding patch observation on the rank that owns it.
-  std::vector<size_t> patchObsCountOnRank(comm_.size(), 0);
-  for (size_t gloc = 0, nglocs = dist_and_lidx_glb.size(); gloc < nglocs; ++gloc) {
-    if (dist_and_lidx_glb[gloc].first < inf) {
-      // This obs is held on at least one rank (this won't be the case e.g. for observations
-      // outside the assimilation window)
-      const size_t rankOwningPatchObs = dist_and_lidx_glb[gloc].second;
-      if (haloLocSet.find(gloc) != haloLocSet.end()) {
-        // This obs is held on the current PE (but not necessarily as a patch obs)
-        globalUniqueConsecutiveLocIndices_.push_back(patchObsCountOnRank[rankOwningPatchObs]);
-      }
-      ++patchObsCountOnRank[rankOwningPatchObs];
-    }
-  }
-
-  // Step 2: make indices of patch observations globally unique by incrementing the index
+    const std::vector<int> &neighbours,
+    const std::vector<std::vector<std::size_t>> &recvRecIndices,
+    const std::vector<std::size_t> &locRecIndices,
+    const std::vector<std::pair<double, int>> &recordOwners) {
+  const int myRank = comm_.rank();
+  const size_t nlocs = haloLocVector_.size();
+  const size_t nneighbours = neighbours.size();
+  globalUniqueConsecutiveLocIndices_.assign(nlocs, 0);
+
+  // Step 1: index patch observations owned by each rank consecutively in the order of increasing
+  // global location index, and make these indices globally unique by incrementing the index
   // of each patch observation held by rank r by the total number of patch observations owned
   // by ranks r' < r.
-
-  // Perform an exclusive scan
-  std::vector<size_t> patchObsCountOnPreviousRanks(patchObsCountOnRank.size(), 0);
-  for (size_t rank = 1; rank < patchObsCountOnRank.size(); ++rank) {
-    patchObsCountOnPreviousRanks[rank] =
-        patchObsCountOnPreviousRanks[rank - 1] + patchObsCountOnRank[rank - 1];
+  std::vector<size_t> patchLocs;
+  for (size_t loc = 0; loc < nlocs; ++loc)
+    if (patchObsBool_[loc])
+      patchLocs.push_back(loc);
+  std::sort(patchLocs.begin(), patchLocs.end(), [this](size_t a, size_t b)
+            { return haloLocVector_[a] < haloLocVector_[b]; });
+
+  size_t patchObsCountOnPreviousRanks = patchLocs.size();
+  oops::mpi::exclusiveScan(comm_, patchObsCountOnPreviousRanks);
+  for (size_t i = 0; i < patchLocs.size(); ++i)
+    globalUniqueConsecutiveLocIndices_[patchLocs[i]] = patchObsCountOnPreviousRanks + i;
+
+  // Step 2: send the indices of patch observations owned by this PE to the neighbours holding
+  // copies of these observations. The neighbours holding a record owned by this PE are exactly
+  // those that have listed that record in step 1 of computePatchLocs().
+  // Pairs (record index, neighbour index), sorted by record index.
+  std::vector<std::pair<size_t, size_t>> neighboursHoldingMyRecords;
+  for (size_t i = 0; i < nneighbours; ++i)
+    for (std::size_t r : recvRecIndices[i])
+      if (r != noRecord && recordOwners[r].second == myRank)
+        neighboursHoldingMyRecords.emplace_back(r, i);
+  std::sort(neighboursHoldingMyRecords.begin(), neighboursHoldingMyRecords.end());
+
+  // Messages consist of pairs (global location index, global unique consecutive index).
+  std::vector<std::vector<size_t>> sendIndices(nneighbours);
+  for (size_t loc : patchLocs) {
+    const size_t r = locRecIndices[loc];
+    auto it = std::lower_bound(neighboursHoldingMyRecords.begin(),
+                               neighboursHoldingMyRecords.end(), std::make_pair(r, size_t(0)));
+    for (; it != neighboursHoldingMyRecords.end() && it->first == r; ++it) {
+      sendIndices[it->second].push_back(haloLocVector_[loc]);
+      sendIndices[it->second].push_back(globalUniqueConsecutiveLocIndices_[loc]);
+    }
   }
-
-  // Increment patch observation indices
-  for (size_t loc = 0; loc < globalUniqueConsecutiveLocIndices_.size(); ++loc) {
-    const size_t gloc = haloLocVector_[loc];
-    const size_t rankOwningPatchObs = dist_and_lidx_glb[gloc].second;
-    globalUniqueConsecutiveLocIndices_[loc] += patchObsCountOnPreviousRanks[rankOwningPatchObs];
+  neighboursHoldingMyRecords.clear();
+
+  // Each PE knows how many of its observations are owned by each neighbour, and hence the
+  // lengths of the messages it will receive.
+  std::vector<int> neighbourIndices(comm_.size(), -1);
+  for (size_t i = 0; i < nneighbours; ++i)
+    neighbourIndices[neighbours[i]] = i;
+  std::vector<size_t> recvCounts(nneighbours, 0);
+  // Pairs (global location index, local location index) of locations not owned by this PE,
+  // sorted by global location index.
+  std::vector<std::pair<size_t, size_t>> nonPatchLocs;
+  for (size_t loc = 0; loc < nlocs; ++loc) {
+    if (!patchObsBool_[loc]) {
+      const int owner = recordOwners[locRecIndices[loc]].second;
+      if (neighbourIndices[owner] < 0)
+        throw eckit::SeriousBug("Halo: a location is owned by a non-neighbouring PE", Here());
+      ++recvCounts[neighbourIndices[owner]];
+      nonPatchLocs.emplace_back(haloLocVector_[loc], loc);
+    }
   }
+  std::sort(nonPatchLocs.begin(), nonPatchLocs.end());
+
+  std::vector<std::vector<size_t>> recvIndices(nneighbours);
+  std::vector<eckit::mpi::Request> requests;
+  requests.reserve(2 * nneighbours);
+  for (size_t i = 0; i < nneighbours; ++i) {
+    recvIndices[i].resize(2 * recvCounts[i]);
+    requests.push_back(comm_.iReceive(recvIndices[i].data(), recvIndices[i].size(),
+                                      neighbours[i], patchIndicesTag));
+  }
+  for (size_t i = 0; i < nneighbours; ++i)
+    requests.push_back(comm_.iSend(sendIndices[i].data(), sendIndices[i].size(),
+                                   neighbours[i], patchIndicesTag));
+  comm_.waitAll(requests);
+
+  for (size_t i = 0; i < nneighbours; ++i)
+    for (size_t j = 0; j < recvIndices[i].size(); j += 2) {
+      auto it = std::lower_bound(nonPatchLocs.begin(), nonPatchLocs.end(),
+                                 std::make_pair(recvIndices[i][j], size_t(0)));
+      if (it == nonPatchLocs.end() || it->first != recvIndices[i][j])
+        throw eckit::SeriousBug("Halo: received the index of an unexpected location", Here());
+      globalUniqueConsecutiveLocIndices_[it->second] = recvIndices[i][j + 1];
+    }
 }
 
 // -----------------------------------------------------------------------------
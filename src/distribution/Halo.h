@@ -8,8 +8,7 @@
 #ifndef DISTRIBUTION_HALO_H_
 #define DISTRIBUTION_HALO_H_
 
-#include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "eckit/geometry/Sphere.h"
@@ -21,6 +20,7 @@
 
 #include "ioda/distribution/Distribution.h"
 #include "ioda/distribution/DistributionParametersBase.h"
+#include "ioda/distribution/RecordSet.h"
 
 namespace ioda {
 
@@ -122,13 +122,45 @@ class Halo: public Distribution {
      template <typename T>
      void allGathervImpl(std::vector<T> &x) const;
 
+     /// Finds the ranks whose halos overlap with the halo of the calling rank, i.e. the only
+     /// ranks that may hold some of the records held on the calling rank.
+     ///
+     /// \param[out] ranks Ranks of the neighbouring halos (excluding the calling rank).
+     /// \param[out] centers Centers of these halos.
+     /// \param[out] radii Radii of these halos.
+     void findNeighbours(std::vector<int> &ranks,
+                         std::vector<eckit::geometry::Point2> &centers,
+                         std::vector<double> &radii) const;
+
+     /// Returns the index of the element of haloRecords_ describing record `recNum`, or
+     /// `noRecord` if that record is not held on this PE. haloRecords_ must be sorted.
+     std::size_t findHaloRecord(std::size_t recNum) const;
+
+     /// \param neighbours Ranks of the neighbouring halos.
+     /// \param recvRecIndices Indices (in haloRecords_) of the records listed by each neighbour.
+     /// \param locRecIndices Indices (in haloRecords_) of the records of locations held on this PE.
+     /// \param recordOwners Distance from the halo center and rank of the owner of each record in
+     ///   haloRecords_.
      void computeGlobalUniqueConsecutiveLocIndices(
-         const std::vector<std::pair<double, int>> &dist_and_lidx_glb);
+         const std::vector<int> &neighbours,
+         const std::vector<std::vector<std::size_t>> &recvRecIndices,
+         const std::vector<std::size_t> &locRecIndices,
+         const std::vector<std::pair<double, int>> &recordOwners);
+
+     /// Information about the first location of a record held on this PE.
+     struct HaloRecord {
+       std::size_t recNum;
+       // Distance to the center of this PE's halo
+       double distance;
+       eckit::geometry::Point2 point;
+     };
+
+     static constexpr std::size_t noRecord = static_cast<std::size_t>(-1);
 
      double radius_;
      eckit::geometry::Point2 center_;
      // Record numbers held on this PE
-     std::unordered_set<std::size_t> recordsInHalo_;
+     RecordSet recordsInHalo_;
      // Indicates which observations held on this PE are "patch obs".
      std::vector<bool> patchObsBool_;
      // Maps indices of locations held on this PE to corresponding elements of vectors
@@ -139,10 +171,10 @@ class Halo: public Distribution {
      // i.e. until the call to computePatchLocs().
 
      // Record numbers not to be held on this PE
-     std::unordered_set<std::size_t> recordsOutsideHalo_;
-     // The distance of the first location of each record held on this PE
-     // to the center of this PE's halo.
-     std::unordered_map<std::size_t, double> recordDistancesFromCenter_;
+     RecordSet recordsOutsideHalo_;
+     // The first location of each record held on this PE and its distance to the center of
+     // this PE's halo (in the order of assignment).
+     std::vector<HaloRecord> haloRecords_;
      // Record numbers of locations held on this PE
      std::vector<size_t> haloLocRecords_;
      // Indices of locations held on this PE
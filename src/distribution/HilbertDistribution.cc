@@ -0,0 +1,141 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "ioda/distribution/HilbertDistribution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <utility>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/mpi/Comm.h"
+#include "ioda/distribution/DistributionFactory.h"
+#include "oops/util/Logger.h"
+
+namespace ioda {
+
+// -----------------------------------------------------------------------------
+static DistributionMaker<HilbertDistribution> maker("Hilbert");
+
+namespace {
+
+// The curve fills a square grid of 2^hilbertOrder x 2^hilbertOrder cells spanning
+// all longitudes and latitudes.
+constexpr unsigned int hilbertOrder = 16;
+constexpr std::uint32_t hilbertGridSize = std::uint32_t(1) << hilbertOrder;
+constexpr std::uint64_t hilbertLength = std::uint64_t(hilbertGridSize) * hilbertGridSize;
+
+std::uint32_t toGridCoordinate(double x, double xmin, double xmax) {
+  const double cell = std::floor((x - xmin) / (xmax - xmin) * hilbertGridSize);
+  return static_cast<std::uint32_t>(
+        std::min(std::max(cell, 0.0), static_cast<double>(hilbertGridSize - 1)));
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+HilbertDistribution::HilbertDistribution(const eckit::mpi::Comm & Comm,
+                                         const Parameters_ &)
+  : NonoverlappingDistribution(Comm) {
+  oops::Log::trace() << "HilbertDistribution constructed" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+HilbertDistribution::~HilbertDistribution() {
+  oops::Log::trace() << "HilbertDistribution destructed" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+std::string HilbertDistribution::name() const {
+  return "Hilbert";
+}
+
+// -----------------------------------------------------------------------------
+std::uint64_t HilbertDistribution::hilbertIndex(const eckit::geometry::Point2 & point) {
+  double lon = std::fmod(point[0], 360.0);
+  if (lon < 0.0)
+    lon += 360.0;
+  std::uint32_t x = toGridCoordinate(lon, 0.0, 360.0);
+  std::uint32_t y = toGridCoordinate(point[1], -90.0, 90.0);
+
+  // Standard conversion of grid coordinates to the distance along the Hilbert curve.
+  std::uint64_t d = 0;
+  for (std::uint32_t s = hilbertGridSize / 2; s > 0; s /= 2) {
+    const std::uint32_t rx = (x & s) > 0;
+    const std::uint32_t ry = (y & s) > 0;
+    d += std::uint64_t(s) * s * ((3 * rx) ^ ry);
+    // Rotate the quadrant
+    if (ry == 0) {
+      if (rx == 1) {
+        x = hilbertGridSize - 1 - x;
+        y = hilbertGridSize - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+// -----------------------------------------------------------------------------
+void HilbertDistribution::assignRecord(const std::size_t RecNum, const std::size_t LocNum,
+                                       const eckit::geometry::Point2 & point) {
+  if (records_.isNew(RecNum)) {
+    // Without knowledge of other records, split the curve into segments of equal length.
+    const std::size_t rank = static_cast<std::size_t>(
+          static_cast<double>(hilbertIndex(point)) / hilbertLength * comm_.size());
+    records_.markAssigned(RecNum, std::min(rank, comm_.size() - 1) == comm_.rank());
+  }
+  NonoverlappingDistribution::assignRecord(RecNum, LocNum, point);
+}
+
+// -----------------------------------------------------------------------------
+void HilbertDistribution::assignRecords(const std::vector<std::size_t> & RecNums,
+                                        const std::vector<std::size_t> & LocNums,
+                                        const std::vector<eckit::geometry::Point2> & points) {
+  ASSERT(RecNums.size() == LocNums.size());
+  ASSERT(RecNums.size() == points.size());
+
+  // Find the position along the curve of the first location of each record encountered for
+  // the first time in this batch.
+  typedef NewRecordTracker::NewRecord NewRecord;
+  std::vector<std::pair<std::uint64_t, NewRecord>> newRecords;
+  std::size_t totalNumLocs = 0;
+  for (const NewRecord & record : records_.newRecords(RecNums)) {
+    newRecords.push_back(std::make_pair(hilbertIndex(points[record.firstLoc]), record));
+    totalNumLocs += record.numLocs;
+  }
+
+  // Sort the records along the curve and split them into contiguous segments with (nearly)
+  // equal numbers of locations.
+  std::sort(newRecords.begin(), newRecords.end(),
+            [](const std::pair<std::uint64_t, NewRecord> & a,
+               const std::pair<std::uint64_t, NewRecord> & b)
+            { return std::tie(a.first, a.second.recNum) < std::tie(b.first, b.second.recNum); });
+
+  const std::size_t nranks = comm_.size();
+  const std::size_t myRank = comm_.rank();
+  std::size_t numLocsInPreviousRecords = 0;
+  for (const auto & indexAndRecord : newRecords) {
+    const NewRecord & record = indexAndRecord.second;
+    const std::size_t rank = numLocsInPreviousRecords * nranks / totalNumLocs;
+    records_.markAssigned(record.recNum, rank == myRank);
+    numLocsInPreviousRecords += record.numLocs;
+  }
+
+  for (std::size_t i = 0; i < RecNums.size(); ++i)
+    NonoverlappingDistribution::assignRecord(RecNums[i], LocNums[i], points[i]);
+}
+
+// -----------------------------------------------------------------------------
+bool HilbertDistribution::isMyRecord(std::size_t RecNum) const {
+  return records_.isMyRecord(RecNum);
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace ioda
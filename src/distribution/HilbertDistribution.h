@@ -0,0 +1,67 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef DISTRIBUTION_HILBERTDISTRIBUTION_H_
+#define DISTRIBUTION_HILBERTDISTRIBUTION_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ioda/distribution/DistributionParametersBase.h"
+#include "ioda/distribution/NonoverlappingDistribution.h"
+#include "ioda/distribution/NewRecordTracker.h"
+
+namespace ioda {
+
+// ---------------------------------------------------------------------
+/*!
+ * \brief Distribution assigning contiguous segments of a Hilbert space-filling curve to
+ * consecutive PEs.
+ *
+ * \details The first location of each record is mapped onto a Hilbert curve covering the
+ *          longitude-latitude plane. When records are assigned a frame at a time (through
+ *          assignRecords()), the records seen for the first time in that frame are sorted
+ *          along the curve and split into as many contiguous segments as there are PEs, each
+ *          holding approximately the same number of locations. Records sharing a segment are
+ *          therefore spatially close, which reduces the amount of data exchanged by spatially
+ *          local operations such as buddy checks or thinning. Since all PEs see the same frames,
+ *          no communication is needed to assign the records.
+ *
+ *          The best spatial locality is obtained with frames holding all observations (the
+ *          `max frame size` option of `obsdatain`). If locations are assigned one at a time
+ *          (through assignRecord()), the curve is split into segments of equal length instead,
+ *          which preserves locality, but not load balance.
+ */
+class HilbertDistribution: public NonoverlappingDistribution {
+ public:
+    typedef EmptyDistributionParameters Parameters_;
+
+    HilbertDistribution(const eckit::mpi::Comm & Comm, const Parameters_ &);
+    ~HilbertDistribution() override;
+
+    void assignRecord(const std::size_t RecNum, const std::size_t LocNum,
+                      const eckit::geometry::Point2 & point) override;
+    void assignRecords(const std::vector<std::size_t> & RecNums,
+                       const std::vector<std::size_t> & LocNums,
+                       const std::vector<eckit::geometry::Point2> & points) override;
+
+    bool isMyRecord(std::size_t RecNum) const override;
+
+    std::string name() const override;
+
+    /// \brief Returns the position of \p point along the Hilbert curve.
+    static std::uint64_t hilbertIndex(const eckit::geometry::Point2 & point);
+
+ private:
+    // Records assigned so far
+    NewRecordTracker records_;
+};
+
+}  // namespace ioda
+
+#endif  // DISTRIBUTION_HILBERTDISTRIBUTION_H_
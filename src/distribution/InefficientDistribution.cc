@@ -92,7 +92,7 @@ InefficientDistribution::createAccumulatorImpl(const std::vector<double> &init)
 template <typename T>
 std::unique_ptr<Accumulator<T>>
 InefficientDistribution::createAccumulatorImplT(const T &init) const {
-  return boost::make_unique<InefficientDistributionAccumulator<T>>(init);
+  return boost::make_unique<InefficientDistributionAccumulator<T>>(init, comm_);
 }
 
 // -----------------------------------------------------------------------------
@@ -11,6 +11,7 @@
 #include <cassert>
 #include <vector>
 
+#include "eckit/mpi/Comm.h"
 #include "ioda/distribution/Accumulator.h"
 
 namespace ioda {
@@ -19,8 +20,8 @@ namespace ioda {
 template <typename T>
 class InefficientDistributionAccumulator : public Accumulator<T> {
  public:
-  explicit InefficientDistributionAccumulator(const T &)
-    : localResult_(0)
+  InefficientDistributionAccumulator(const T &, const eckit::mpi::Comm &comm)
+    : localResult_(0), comm_(comm)
   {}
 
   void addTerm(std::size_t /*loc*/, const T &term) override {
@@ -31,16 +32,22 @@ class InefficientDistributionAccumulator : public Accumulator<T> {
     return localResult_;
   }
 
+  T computeLocalContribution() const override {
+    // All PEs hold the same observations, but only rank 0 owns them.
+    return comm_.rank() == 0 ? localResult_ : 0;
+  }
+
  private:
   T localResult_;
+  const eckit::mpi::Comm &comm_;
 };
 
 template <typename T>
 class InefficientDistributionAccumulator<std::vector<T>> : public Accumulator<std::vector<T>> {
  public:
   /// Note: only the length of the `init` vector matters -- the values of its elements are ignored.
-  explicit InefficientDistributionAccumulator(const std::vector<T> &init)
-    : localResult_(init.size(), 0)
+  InefficientDistributionAccumulator(const std::vector<T> &init, const eckit::mpi::Comm &comm)
+    : localResult_(init.size(), 0), comm_(comm)
   {}
 
   void addTerm(std::size_t /*loc*/, const std::vector<T> &term) override {
@@ -59,8 +66,16 @@ class InefficientDistributionAccumulator<std::vector<T>> : public Accumulator<st
     return localResult_;
   }
 
+  std::vector<T> computeLocalContribution() const override {
+    // All PEs hold the same observations, but only rank 0 owns them.
+    if (comm_.rank() == 0)
+      return localResult_;
+    return std::vector<T>(localResult_.size(), 0);
+  }
+
  private:
   std::vector<T> localResult_;
+  const eckit::mpi::Comm &comm_;
 };
 
 }  // namespace ioda
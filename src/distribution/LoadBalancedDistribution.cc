@@ -0,0 +1,91 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "ioda/distribution/LoadBalancedDistribution.h"
+
+#include <algorithm>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/mpi/Comm.h"
+#include "ioda/distribution/DistributionFactory.h"
+#include "oops/util/Logger.h"
+
+namespace ioda {
+
+// -----------------------------------------------------------------------------
+static DistributionMaker<LoadBalancedDistribution> maker("LoadBalanced");
+
+// -----------------------------------------------------------------------------
+LoadBalancedDistribution::LoadBalancedDistribution(const eckit::mpi::Comm & Comm,
+                                                   const Parameters_ &)
+  : NonoverlappingDistribution(Comm), numLocsOnRank_(Comm.size(), 0) {
+  oops::Log::trace() << "LoadBalancedDistribution constructed" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+LoadBalancedDistribution::~LoadBalancedDistribution() {
+  oops::Log::trace() << "LoadBalancedDistribution destructed" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+std::string LoadBalancedDistribution::name() const {
+  return "LoadBalanced";
+}
+
+// -----------------------------------------------------------------------------
+std::size_t LoadBalancedDistribution::assignToLeastLoadedRank(std::size_t RecNum,
+                                                              std::size_t recordSize) {
+  // Ties are resolved in favour of the lowest rank, so all PEs make the same choice.
+  const std::size_t rank = std::min_element(numLocsOnRank_.begin(), numLocsOnRank_.end()) -
+                           numLocsOnRank_.begin();
+  numLocsOnRank_[rank] += recordSize;
+  records_.markAssigned(RecNum, rank == comm_.rank());
+  return rank;
+}
+
+// -----------------------------------------------------------------------------
+void LoadBalancedDistribution::assignRecord(const std::size_t RecNum, const std::size_t LocNum,
+                                            const eckit::geometry::Point2 & point) {
+  if (records_.isNew(RecNum))
+    assignToLeastLoadedRank(RecNum, 1);
+  NonoverlappingDistribution::assignRecord(RecNum, LocNum, point);
+}
+
+// -----------------------------------------------------------------------------
+void LoadBalancedDistribution::assignRecords(
+    const std::vector<std::size_t> & RecNums,
+    const std::vector<std::size_t> & LocNums,
+    const std::vector<eckit::geometry::Point2> & points) {
+  ASSERT(RecNums.size() == LocNums.size());
+  ASSERT(RecNums.size() == points.size());
+
+  // Records encountered for the first time in this batch, with their numbers of locations.
+  typedef NewRecordTracker::NewRecord NewRecord;
+  std::vector<NewRecord> newRecords = records_.newRecords(RecNums);
+
+  // Longest-processing-time rule: largest records first (ties resolved by record number).
+  std::sort(newRecords.begin(), newRecords.end(),
+            [](const NewRecord & a, const NewRecord & b)
+            { return a.numLocs > b.numLocs || (a.numLocs == b.numLocs && a.recNum < b.recNum); });
+  for (const NewRecord & record : newRecords)
+    assignToLeastLoadedRank(record.recNum, record.numLocs);
+
+  oops::Log::debug() << "LoadBalancedDistribution: number of locations assigned to this PE: "
+                     << numLocsOnRank_[comm_.rank()] << std::endl;
+
+  for (std::size_t i = 0; i < RecNums.size(); ++i)
+    NonoverlappingDistribution::assignRecord(RecNums[i], LocNums[i], points[i]);
+}
+
+// -----------------------------------------------------------------------------
+bool LoadBalancedDistribution::isMyRecord(std::size_t RecNum) const {
+  return records_.isMyRecord(RecNum);
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace ioda
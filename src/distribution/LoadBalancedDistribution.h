@@ -0,0 +1,65 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef DISTRIBUTION_LOADBALANCEDDISTRIBUTION_H_
+#define DISTRIBUTION_LOADBALANCEDDISTRIBUTION_H_
+
+#include <string>
+#include <vector>
+
+#include "ioda/distribution/DistributionParametersBase.h"
+#include "ioda/distribution/NonoverlappingDistribution.h"
+#include "ioda/distribution/NewRecordTracker.h"
+
+namespace ioda {
+
+// ---------------------------------------------------------------------
+/*!
+ * \brief Distribution balancing the number of locations held by each PE while keeping
+ * records whole.
+ *
+ * \details Unlike RoundRobin, which ignores record sizes, this distribution takes into account
+ *          the number of locations in each record. When records are assigned a frame at a time
+ *          (through assignRecords()), the records seen for the first time in that frame are
+ *          assigned using the greedy longest-processing-time rule: records are taken in order of
+ *          decreasing size and each is given to the PE currently holding the fewest locations.
+ *          Since all PEs see the same frames, no communication is needed to assign the records.
+ *
+ *          Only the locations of a record found in the frame in which it first appears count
+ *          towards the load of its PE. If locations are assigned one at a time (through
+ *          assignRecord()), each record is counted as a single location.
+ */
+class LoadBalancedDistribution: public NonoverlappingDistribution {
+ public:
+    typedef EmptyDistributionParameters Parameters_;
+
+    LoadBalancedDistribution(const eckit::mpi::Comm & Comm, const Parameters_ &);
+    ~LoadBalancedDistribution() override;
+
+    void assignRecord(const std::size_t RecNum, const std::size_t LocNum,
+                      const eckit::geometry::Point2 & point) override;
+    void assignRecords(const std::vector<std::size_t> & RecNums,
+                       const std::vector<std::size_t> & LocNums,
+                       const std::vector<eckit::geometry::Point2> & points) override;
+
+    bool isMyRecord(std::size_t RecNum) const override;
+
+    std::string name() const override;
+
+ private:
+    /// Assigns a record of size \p recordSize to the least loaded PE and returns its rank.
+    std::size_t assignToLeastLoadedRank(std::size_t RecNum, std::size_t recordSize);
+
+    // Records assigned so far
+    NewRecordTracker records_;
+    // Number of locations assigned to each PE so far
+    std::vector<std::size_t> numLocsOnRank_;
+};
+
+}  // namespace ioda
+
+#endif  // DISTRIBUTION_LOADBALANCEDDISTRIBUTION_H_
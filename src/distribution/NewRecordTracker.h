@@ -0,0 +1,78 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef DISTRIBUTION_NEWRECORDTRACKER_H_
+#define DISTRIBUTION_NEWRECORDTRACKER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ioda/distribution/RecordSet.h"
+
+namespace ioda {
+
+// ---------------------------------------------------------------------
+/*!
+ * \brief Keeps track of the records assigned so far by a distribution assigning records a
+ * frame at a time.
+ *
+ * \details It is assumed that records are numbered in the order in which their first locations
+ *          are encountered, so the records not assigned yet are those with numbers at least
+ *          equal to the number following the last assigned record.
+ */
+class NewRecordTracker {
+ public:
+  /// \brief A record encountered for the first time in a batch of locations.
+  struct NewRecord {
+    /// Record number.
+    std::size_t recNum;
+    /// Index (within the batch) of the first location of the record.
+    std::size_t firstLoc;
+    /// Number of locations of the record in the batch.
+    std::size_t numLocs;
+  };
+
+  /// \brief Return true if `recNum` hasn't been assigned yet.
+  bool isNew(std::size_t recNum) const { return recNum >= nextRecordToAssign_; }
+
+  /// \brief Return the records of the locations with record numbers `recNums` that haven't been
+  /// assigned yet, in the order of their first locations.
+  std::vector<NewRecord> newRecords(const std::vector<std::size_t> & recNums) const {
+    std::vector<NewRecord> records;
+    std::unordered_map<std::size_t, std::size_t> recordIndices;
+    for (std::size_t i = 0; i < recNums.size(); ++i) {
+      if (!isNew(recNums[i]))
+        continue;
+      auto inserted = recordIndices.insert(std::make_pair(recNums[i], records.size()));
+      if (inserted.second)
+        records.push_back(NewRecord{recNums[i], i, 0});
+      ++records[inserted.first->second].numLocs;
+    }
+    return records;
+  }
+
+  /// \brief Record that `recNum` has been assigned, to this PE if `isMine` is true.
+  void markAssigned(std::size_t recNum, bool isMine) {
+    if (isMine)
+      myRecords_.insert(recNum);
+    nextRecordToAssign_ = std::max(nextRecordToAssign_, recNum + 1);
+  }
+
+  /// \brief Return true if `recNum` has been assigned to this PE.
+  bool isMyRecord(std::size_t recNum) const { return myRecords_.contains(recNum); }
+
+ private:
+  RecordSet myRecords_;
+  std::size_t nextRecordToAssign_ = 0;
+};
+
+}  // namespace ioda
+
+#endif  // DISTRIBUTION_NEWRECORDTRACKER_H_
@@ -34,6 +34,10 @@ class NonoverlappingDistributionAccumulator : public Accumulator<T> {
     return result;
   }
 
+  T computeLocalContribution() const override {
+    return localResult_;
+  }
+
  private:
   T localResult_;
   const eckit::mpi::Comm &comm_;
@@ -65,6 +69,10 @@ class NonoverlappingDistributionAccumulator<std::vector<T>> : public Accumulator
     return result;
   }
 
+  std::vector<T> computeLocalContribution() const override {
+    return localResult_;
+  }
+
  private:
   std::vector<T> localResult_;
   const eckit::mpi::Comm &comm_;
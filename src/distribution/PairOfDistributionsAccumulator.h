@@ -39,6 +39,11 @@ class PairOfDistributionsAccumulator : public Accumulator<T> {
     return firstAccumulator_->computeResult() + secondAccumulator_->computeResult();
   }
 
+  T computeLocalContribution() const override {
+    return firstAccumulator_->computeLocalContribution() +
+           secondAccumulator_->computeLocalContribution();
+  }
+
  private:
   std::unique_ptr<Accumulator<T>> firstAccumulator_;
   std::unique_ptr<Accumulator<T>> secondAccumulator_;
@@ -79,6 +84,14 @@ class PairOfDistributionsAccumulator<std::vector<T>> : public Accumulator<std::v
     return result;
   }
 
+  std::vector<T> computeLocalContribution() const override {
+    std::vector<T> result = firstAccumulator_->computeLocalContribution();
+    std::vector<T> secondResult = secondAccumulator_->computeLocalContribution();
+    for (std::size_t i = 0, n = result.size(); i < n; ++i)
+      result[i] += secondResult[i];
+    return result;
+  }
+
  private:
   std::unique_ptr<Accumulator<std::vector<T>>> firstAccumulator_;
   std::unique_ptr<Accumulator<std::vector<T>>> secondAccumulator_;
@@ -0,0 +1,39 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "ioda/distribution/RebalancedDistribution.h"
+
+#include "oops/util/Logger.h"
+
+namespace ioda {
+
+// -----------------------------------------------------------------------------
+// Note: we don't declare an instance of DistributionMaker<RebalancedDistribution>,
+// since this distribution must be created programmatically (not from YAML).
+
+// -----------------------------------------------------------------------------
+RebalancedDistribution::RebalancedDistribution(const eckit::mpi::Comm &comm,
+                                               const std::vector<std::size_t> &myRecords)
+  : NonoverlappingDistribution(comm) {
+  for (std::size_t recNum : myRecords)
+    myRecords_.insert(recNum);
+  oops::Log::trace() << "RebalancedDistribution constructed" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+RebalancedDistribution::~RebalancedDistribution() {
+  oops::Log::trace() << "RebalancedDistribution destructed" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+bool RebalancedDistribution::isMyRecord(std::size_t RecNum) const {
+  return myRecords_.contains(RecNum);
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace ioda
@@ -0,0 +1,51 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef DISTRIBUTION_REBALANCEDDISTRIBUTION_H_
+#define DISTRIBUTION_REBALANCEDDISTRIBUTION_H_
+
+#include <string>
+#include <vector>
+
+#include "ioda/distribution/NonoverlappingDistribution.h"
+#include "ioda/distribution/RecordSet.h"
+
+namespace ioda {
+
+// ---------------------------------------------------------------------
+/*!
+ * \brief Non-overlapping distribution assigning to each process an explicitly specified
+ * list of records.
+ *
+ * This distribution is produced by ObsSpace::rebalance(), which moves records between processes
+ * after the records have been read.
+ */
+class RebalancedDistribution : public NonoverlappingDistribution {
+ public:
+    /// \brief Constructor.
+    ///
+    /// \param comm
+    ///   Communicator.
+    /// \param myRecords
+    ///   Numbers of the records assigned to the calling process. The sets of records passed
+    ///   on different processes must be disjoint.
+    RebalancedDistribution(const eckit::mpi::Comm &comm,
+                           const std::vector<std::size_t> &myRecords);
+
+    ~RebalancedDistribution() override;
+
+    bool isMyRecord(std::size_t RecNum) const override;
+
+    std::string name() const override { return "RebalancedDistribution"; }
+
+ private:
+    RecordSet myRecords_;
+};
+
+}  // namespace ioda
+
+#endif  // DISTRIBUTION_REBALANCEDDISTRIBUTION_H_
@@ -0,0 +1,80 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef DISTRIBUTION_RECORDSET_H_
+#define DISTRIBUTION_RECORDSET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ioda {
+
+// ---------------------------------------------------------------------
+/*!
+ * \brief Set of record numbers stored as a dense bitmap.
+ *
+ * \details Records are numbered consecutively, so the records held on a PE occupy a limited
+ *          span of record numbers. This class stores one bit for each record number in the span
+ *          between the smallest and the largest number inserted so far, which makes membership
+ *          tests a shift and a mask instead of a hash probe and costs one bit per record
+ *          instead of a heap-allocated node.
+ */
+class RecordSet {
+ public:
+  /// \brief Add `recNum` to the set.
+  void insert(std::size_t recNum) {
+    const std::size_t word = recNum / bitsPerWord;
+    if (words_.empty()) {
+      firstWord_ = word;
+      words_.push_back(0);
+    } else if (word < firstWord_) {
+      words_.insert(words_.begin(), firstWord_ - word, 0);
+      firstWord_ = word;
+    } else if (word >= firstWord_ + words_.size()) {
+      words_.resize(word - firstWord_ + 1, 0);
+    }
+    const Word mask = Word(1) << (recNum % bitsPerWord);
+    Word &w = words_[word - firstWord_];
+    if (!(w & mask)) {
+      w |= mask;
+      ++size_;
+    }
+  }
+
+  /// \brief Return true if `recNum` belongs to the set.
+  bool contains(std::size_t recNum) const {
+    const std::size_t word = recNum / bitsPerWord;
+    if (word < firstWord_ || word >= firstWord_ + words_.size())
+      return false;
+    return (words_[word - firstWord_] >> (recNum % bitsPerWord)) & 1;
+  }
+
+  /// \brief Return the number of records in the set.
+  std::size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  /// \brief Remove all records and release the memory used by the bitmap.
+  void clear() {
+    std::vector<Word>().swap(words_);
+    firstWord_ = 0;
+    size_ = 0;
+  }
+
+ private:
+  typedef std::uint64_t Word;
+  static constexpr std::size_t bitsPerWord = 64;
+
+  std::vector<Word> words_;
+  std::size_t firstWord_ = 0;
+  std::size_t size_ = 0;
+};
+
+}  // namespace ioda
+
+#endif  // DISTRIBUTION_RECORDSET_H_
@@ -0,0 +1,189 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef DISTRIBUTION_REDUCTIONBATCH_H_
+#define DISTRIBUTION_REDUCTIONBATCH_H_
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/mpi/Comm.h"
+#include "ioda/distribution/Accumulator.h"
+#include "ioda/distribution/Distribution.h"
+
+namespace ioda {
+
+// ---------------------------------------------------------------------
+/*!
+ * \brief Batch of global reductions executed with as few collective operations as possible.
+ *
+ * \details Each call to Distribution::min(), Distribution::max() or
+ *          Accumulator::computeResult() issues its own collective operation, so computing
+ *          several statistics one after another results in as many round trips through the
+ *          network. A ReductionBatch collects reductions of many scalars and vectors and
+ *          performs them all in execute(), packing the values of each type into a single buffer
+ *          and issuing at most one allreduce per type and operator. Minima of floating-point
+ *          values are computed as maxima of their negations, so that they share a collective
+ *          operation with the maxima of the same type.
+ *
+ *          The reductions have the same semantics as the corresponding functions of the
+ *          distribution passed to the constructor. Usage:
+ *
+ *              ReductionBatch batch(dist);
+ *              batch.sum(*accumulator, sum);
+ *              batch.min(zmin);
+ *              batch.max(zmax);
+ *              batch.execute();  // sum, zmin and zmax now hold the global results
+ *
+ *          The variables passed to min(), max() and sum() must remain valid (and vectors must
+ *          not be resized) until execute() has been called. Like all collective operations,
+ *          the reductions must be added to the batch in the same order on all processes.
+ *
+ *          Supported types: int, std::size_t, float and double.
+ */
+class ReductionBatch {
+ public:
+  explicit ReductionBatch(const Distribution & dist)
+    : comm_(dist.comm())
+  {}
+
+  /// \brief Replace `x` by its minimum over all processes when execute() is called.
+  template <typename T>
+  void min(T & x) {
+    addMin(&x, 1);
+  }
+
+  /// \brief Replace each element of `x` by its minimum over all processes when execute() is
+  /// called.
+  template <typename T>
+  void min(std::vector<T> & x) {
+    addMin(x.data(), x.size());
+  }
+
+  /// \brief Replace `x` by its maximum over all processes when execute() is called.
+  template <typename T>
+  void max(T & x) {
+    addMax(&x, 1);
+  }
+
+  /// \brief Replace each element of `x` by its maximum over all processes when execute() is
+  /// called.
+  template <typename T>
+  void max(std::vector<T> & x) {
+    addMax(x.data(), x.size());
+  }
+
+  /// \brief Store the value that would be returned by `accumulator.computeResult()` in `result`
+  /// when execute() is called.
+  ///
+  /// The local contribution is taken from the accumulator immediately, so the accumulator does
+  /// not need to outlive this call.
+  template <typename T>
+  void sum(const Accumulator<T> & accumulator, T & result) {
+    result = accumulator.computeLocalContribution();
+    add(reductions<T>().sum, &result, 1);
+  }
+
+  /// \brief Store the values that would be returned by `accumulator.computeResult()` in `result`
+  /// when execute() is called.
+  template <typename T>
+  void sum(const Accumulator<std::vector<T>> & accumulator, std::vector<T> & result) {
+    result = accumulator.computeLocalContribution();
+    add(reductions<T>().sum, result.data(), result.size());
+  }
+
+  /// \brief Perform all reductions added to the batch since the last call to this function.
+  void execute() {
+    execute(std::get<Reductions<int>>(reductions_));
+    execute(std::get<Reductions<std::size_t>>(reductions_));
+    execute(std::get<Reductions<float>>(reductions_));
+    execute(std::get<Reductions<double>>(reductions_));
+  }
+
+ private:
+  /// Values to be reduced with a particular operator and the variables receiving the results.
+  template <typename T>
+  struct PackedValues {
+    std::vector<T> values;
+    std::vector<T *> targets;
+  };
+
+  template <typename T>
+  struct Reductions {
+    PackedValues<T> sum;
+    PackedValues<T> min;
+    PackedValues<T> max;
+    /// Variables whose minima are computed as negated maxima.
+    std::vector<T *> negatedTargets;
+  };
+
+  template <typename T>
+  Reductions<T> & reductions() {
+    return std::get<Reductions<T>>(reductions_);
+  }
+
+  template <typename T>
+  static void add(PackedValues<T> & packed, T * x, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      packed.values.push_back(x[i]);
+      packed.targets.push_back(x + i);
+    }
+  }
+
+  template <typename T>
+  void addMin(T * x, std::size_t n) {
+    Reductions<T> & r = reductions<T>();
+    if (std::is_floating_point<T>::value) {
+      // min(x) == -max(-x); the negated values are restored in execute().
+      for (std::size_t i = 0; i < n; ++i) {
+        r.max.values.push_back(-x[i]);
+        r.max.targets.push_back(x + i);
+        r.negatedTargets.push_back(x + i);
+      }
+    } else {
+      add(r.min, x, n);
+    }
+  }
+
+  template <typename T>
+  void addMax(T * x, std::size_t n) {
+    add(reductions<T>().max, x, n);
+  }
+
+  template <typename T>
+  void execute(PackedValues<T> & packed, eckit::mpi::Operation::Code op) {
+    ASSERT(packed.values.size() == packed.targets.size());
+    if (packed.values.empty())
+      return;
+    comm_.allReduceInPlace(packed.values.begin(), packed.values.end(), op);
+    for (std::size_t i = 0; i < packed.values.size(); ++i)
+      *packed.targets[i] = packed.values[i];
+    packed.values.clear();
+    packed.targets.clear();
+  }
+
+  template <typename T>
+  void execute(Reductions<T> & r) {
+    execute(r.sum, eckit::mpi::sum());
+    execute(r.min, eckit::mpi::min());
+    execute(r.max, eckit::mpi::max());
+    for (T * x : r.negatedTargets)
+      *x = -*x;
+    r.negatedTargets.clear();
+  }
+
+  const eckit::mpi::Comm & comm_;
+  std::tuple<Reductions<int>, Reductions<std::size_t>,
+             Reductions<float>, Reductions<double>> reductions_;
+};
+
+}  // namespace ioda
+
+#endif  // DISTRIBUTION_REDUCTIONBATCH_H_
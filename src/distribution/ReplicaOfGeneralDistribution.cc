@@ -7,6 +7,8 @@
 
 #include "ioda/distribution/ReplicaOfGeneralDistribution.h"
 
+#include <algorithm>
+
 #include <boost/make_unique.hpp>
 
 #include "oops/mpi/mpi.h"
@@ -52,45 +54,98 @@ void ReplicaOfGeneralDistribution::assignRecord(const std::size_t RecNum, const
   if (masterDist_->isMyRecord(RecNum)) {
     myRecords_.insert(RecNum);
     myGlobalLocs_.push_back(LocNum);
-    isMyPatchObs_.push_back(masterPatchRecords_.find(RecNum) != masterPatchRecords_.end());
+    isMyPatchObs_.push_back(masterPatchRecords_.contains(RecNum));
   }
 }
 
 // -----------------------------------------------------------------------------
 bool ReplicaOfGeneralDistribution::isMyRecord(std::size_t RecNum) const {
-  return myRecords_.find(RecNum) != myRecords_.end();
+  return myRecords_.contains(RecNum);
 }
 
 // -----------------------------------------------------------------------------
 void ReplicaOfGeneralDistribution::computePatchLocs() {
+  const std::size_t nranks = comm_.size();
+  const std::size_t UNASSIGNED = static_cast<size_t>(-1);
+
   // Find the maximum global location index (plus 1)
   size_t nglocs = 0;
   if (!myGlobalLocs_.empty())
     nglocs = myGlobalLocs_.back() + 1;
   comm_.allReduceInPlace(nglocs, eckit::mpi::max());
 
-  // Collect the global location indices of all patch obs on the current process.
-  std::vector<std::size_t> patchObsGlobalLocs;
-  for (std::size_t i = 0, n = myGlobalLocs_.size(); i < n; ++i)
-    if (isMyPatchObs_[i])
-      patchObsGlobalLocs.push_back(myGlobalLocs_[i]);
-  // Merge with vectors collected on other processes (ordered by MPI rank).
-  oops::mpi::allGatherv(comm_, patchObsGlobalLocs);
-
   // Assign consecutive indices to patch obs ordered by MPI rank.
   // (It is assumed that each location belongs to the patch of some process).
-  const std::size_t UNASSIGNED = static_cast<size_t>(-1);
-  std::vector<std::size_t> consecutiveLocIndices(nglocs, UNASSIGNED);
-  for (std::size_t i = 0, n = patchObsGlobalLocs.size(); i < n; ++i)
-    consecutiveLocIndices.at(patchObsGlobalLocs[i]) = i;
-
-  // Find and save the indices of all obs held on the current process.
-  globalUniqueConsecutiveLocIndices_.resize(myGlobalLocs_.size());
-  for (std::size_t loc = 0; loc < myGlobalLocs_.size(); ++loc) {
-    globalUniqueConsecutiveLocIndices_[loc] = consecutiveLocIndices[myGlobalLocs_[loc]];
+  std::size_t numPatchObs = std::count(isMyPatchObs_.begin(), isMyPatchObs_.end(), true);
+  std::size_t numPatchObsOnLowerRanks = numPatchObs;
+  oops::mpi::exclusiveScan(comm_, numPatchObsOnLowerRanks);
+
+  globalUniqueConsecutiveLocIndices_.assign(myGlobalLocs_.size(), UNASSIGNED);
+  for (std::size_t loc = 0, i = numPatchObsOnLowerRanks; loc < myGlobalLocs_.size(); ++loc)
+    if (isMyPatchObs_[loc])
+      globalUniqueConsecutiveLocIndices_[loc] = i++;
+
+  // The indices of obs held on other processes as patch obs are looked up in a distributed
+  // directory: the range of global location indices is split into contiguous blocks, the
+  // ith of which is stored on the process of rank i.
+  const std::size_t blockSize = std::max<std::size_t>(1, (nglocs + nranks - 1) / nranks);
+  auto directoryRank = [blockSize](std::size_t gloc) { return gloc / blockSize; };
+
+  // Step 1: register the indices of patch obs in the directory. Messages consist of pairs
+  // (global location index, global unique consecutive index).
+  std::vector<std::size_t> directory;
+  {
+    std::vector<std::vector<std::size_t>> sendBuffers(nranks);
+    for (std::size_t loc = 0; loc < myGlobalLocs_.size(); ++loc) {
+      if (isMyPatchObs_[loc]) {
+        std::vector<std::size_t> &buffer = sendBuffers[directoryRank(myGlobalLocs_[loc])];
+        buffer.push_back(myGlobalLocs_[loc]);
+        buffer.push_back(globalUniqueConsecutiveLocIndices_[loc]);
+      }
+    }
+    std::vector<std::vector<std::size_t>> recvBuffers(nranks);
+    comm_.allToAll(sendBuffers, recvBuffers);
+
+    const std::size_t directoryStart = comm_.rank() * blockSize;
+    const std::size_t directoryEnd = std::min(nglocs, directoryStart + blockSize);
+    directory.assign(directoryEnd > directoryStart ? directoryEnd - directoryStart : 0,
+                     UNASSIGNED);
+    for (const std::vector<std::size_t> &buffer : recvBuffers)
+      for (std::size_t i = 0; i < buffer.size(); i += 2)
+        directory.at(buffer[i] - directoryStart) = buffer[i + 1];
+  }
+
+  // Step 2: query the directory for the indices of the remaining obs held on this process.
+  {
+    std::vector<std::vector<std::size_t>> queries(nranks);
+    std::vector<std::vector<std::size_t>> queryLocs(nranks);
+    for (std::size_t loc = 0; loc < myGlobalLocs_.size(); ++loc) {
+      if (!isMyPatchObs_[loc]) {
+        const std::size_t rank = directoryRank(myGlobalLocs_[loc]);
+        queries[rank].push_back(myGlobalLocs_[loc]);
+        queryLocs[rank].push_back(loc);
+      }
+    }
+    std::vector<std::vector<std::size_t>> receivedQueries(nranks);
+    comm_.allToAll(queries, receivedQueries);
+
+    const std::size_t directoryStart = comm_.rank() * blockSize;
+    for (std::vector<std::size_t> &buffer : receivedQueries)
+      for (std::size_t &gloc : buffer)
+        gloc = directory.at(gloc - directoryStart);
+    directory.clear();
+    directory.shrink_to_fit();
+
+    std::vector<std::vector<std::size_t>> answers(nranks);
+    comm_.allToAll(receivedQueries, answers);
+    for (std::size_t rank = 0; rank < nranks; ++rank)
+      for (std::size_t i = 0; i < answers[rank].size(); ++i)
+        globalUniqueConsecutiveLocIndices_[queryLocs[rank][i]] = answers[rank][i];
+  }
+
+  for (std::size_t loc = 0; loc < myGlobalLocs_.size(); ++loc)
     if (globalUniqueConsecutiveLocIndices_[loc] == UNASSIGNED)
       throw eckit::SeriousBug("A location does not belong to the patch of any process");
-  }
 
   // Free memory.
   masterPatchRecords_.clear();
@@ -8,10 +8,10 @@
 #ifndef DISTRIBUTION_REPLICAOFGENERALDISTRIBUTION_H_
 #define DISTRIBUTION_REPLICAOFGENERALDISTRIBUTION_H_
 
-#include <unordered_set>
 #include <vector>
 
 #include "ioda/distribution/Distribution.h"
+#include "ioda/distribution/RecordSet.h"
 
 namespace ioda {
 
@@ -93,14 +93,11 @@ class ReplicaOfGeneralDistribution : public Distribution {
   template <typename T>
   void allGathervImpl(std::vector<T> &x) const;
 
-  void computeGlobalUniqueConsecutiveLocIndices(
-      const std::vector<std::pair<double, int>> &dist_and_lidx_glb);
-
   std::shared_ptr<const Distribution> masterDist_;
   std::size_t numMasterLocs_;
-  std::unordered_set<std::size_t> masterPatchRecords_;
+  RecordSet masterPatchRecords_;
 
-  std::unordered_set<std::size_t> myRecords_;
+  RecordSet myRecords_;
   std::vector<std::size_t> myGlobalLocs_;
   std::vector<bool> isMyPatchObs_;
   // Maps indices of locations held on this PE to corresponding elements of vectors
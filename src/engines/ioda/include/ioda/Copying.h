@@ -12,6 +12,7 @@
 #include <gsl/gsl-lite.hpp>
 #include <memory>
 #include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -31,4 +32,13 @@ IODA_DL void copyAttributes(const ioda::Has_Attributes& src, ioda::Has_Attribute
 /// \param dest is the destination group
 IODA_DL void copyGroup(const ioda::Group & src, ioda::Group & dest);
 
+/// \brief Copy some of the variables of group src to dest
+/// \details All of the dimension scales are copied, together with the listed variables and
+///          the groups (and their attributes) holding them.
+/// \param src is the source group
+/// \param dest is the destination group
+/// \param varNames names (including the group path) of the regular variables to be copied
+IODA_DL void copyGroup(const ioda::Group & src, ioda::Group & dest,
+                       const std::vector<std::string> & varNames);
+
 }  // namespace ioda
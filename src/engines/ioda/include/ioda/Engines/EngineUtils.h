@@ -80,6 +80,17 @@ public:
   MPI_Comm comm;
   std::size_t allocBytes;
   bool flush;
+  /// Size (in bytes) of the chunk cache of the file (0 keeps the HDF5 default).
+  std::size_t chunkCacheSize = 0;
+  /// Size (in bytes) of the members of a new file family (0 creates a single file).
+  std::size_t familyMemberSize = 0;
+  /// @}
+  /// @name ObsStore
+  /// @{
+  /// Directory for memory-mapped scratch files (empty keeps everything in heap memory).
+  std::string scratchDirectory;
+  /// Size (in bytes) above which the values of a Variable are memory-mapped.
+  std::size_t mappedThreshold = 16 * 1024 * 1024;
   /// @}
 
   BackendCreationParameters() { }
@@ -79,17 +79,46 @@ IODA_DL Group createParallelFile(const std::string& filename, BackendCreateModes
 /// \param compat is the range of HDF5 versions that should be able to access this file.
 /// \param mpiComm is the MPI communicator group (for parallel access)
 /// \param isParallelIo when true create the file for parallel access (by all ranks in comm)
+/// \param chunkCacheSize size in bytes of the raw data chunk cache (0 keeps the HDF5 default)
+/// \param familyMemberSize when non-zero, write the file as an HDF5 file family made of
+///   members of this size (in bytes). The file name must then contain a printf-style integer
+///   conversion (such as %04d) which is replaced by the member number. Not available in
+///   parallel access mode.
 IODA_DL Group createFileImpl(const std::string& filename, BackendCreateModes mode,
-              HDF5_Version_Range compat, const MPI_Comm mpiComm, const bool isParallelIo);
+              HDF5_Version_Range compat, const MPI_Comm mpiComm, const bool isParallelIo,
+              const std::size_t chunkCacheSize = 0, const std::size_t familyMemberSize = 0);
 
-/// \brief Open a ioda::Group backed by an HDF5 file.
+/// \brief Check if a file name names an HDF5 file family.
 /// \ingroup ioda_cxx_engines_pub_HH
+/// \details A file family is named by a pattern containing a printf-style integer
+///   conversion (such as %d or %04d) which is replaced by the member number. A literal
+///   percent sign is written as %%.
 /// \param filename is the file name.
+IODA_DL bool isFamilyFileName(const std::string& filename);
+
+/// \brief Open a ioda::Group backed by an HDF5 file.
+/// \ingroup ioda_cxx_engines_pub_HH
+/// \param filename is the file name. If it names a file family (see isFamilyFileName), all
+///   of the members of the family are opened as a single file.
 /// \param mode is the access mode.
 /// \param compat is the range of HDF5 versions that should be able to access this file.
 IODA_DL Group openFile(const std::string& filename, BackendOpenModes mode,
                        HDF5_Version_Range compat = defaultVersionRange());
 
+/// \brief Open a ioda::Group backed by an HDF5 file (with either serial or parallel access).
+/// \ingroup ioda_cxx_engines_pub_HH
+/// \param filename is the file name. If it names a file family (see isFamilyFileName), all
+///   of the members of the family are opened as a single file. Not available in parallel
+///   access mode.
+/// \param mode is the access mode.
+/// \param compat is the range of HDF5 versions that should be able to access this file.
+/// \param mpiComm is the MPI communicator group (for parallel access)
+/// \param isParallelIo when true open the file for parallel access (by all ranks in comm)
+/// \param chunkCacheSize size in bytes of the raw data chunk cache (0 keeps the HDF5 default)
+IODA_DL Group openFileImpl(const std::string& filename, BackendOpenModes mode,
+              HDF5_Version_Range compat, const MPI_Comm mpiComm, const bool isParallelIo,
+              const std::size_t chunkCacheSize = 0);
+
 /// \brief Create a ioda::Group backed by the HDF5 in-memory-store.
 /// \ingroup ioda_cxx_engines_pub_HH
 /// \param filename is the name of the file if it gets flushed
@@ -142,6 +171,17 @@ IODA_DL Capabilities getCapabilitiesFileEngine();
 /// \ingroup ioda_cxx_engines_pub_HH
 IODA_DL Capabilities getCapabilitiesInMemoryEngine();
 
+/// \brief Can the HDF5 library write variable-length strings to files opened for parallel IO?
+/// \details Requires HDF5 1.14.3 or later. Older versions only support fixed-length strings
+///   with the MPI-IO file driver.
+/// \ingroup ioda_cxx_engines_pub_HH
+IODA_DL bool canWriteVarLenStringsInParallel();
+
+/// \brief Was the HDF5 library built with thread safety enabled?
+/// \details Only a thread-safe library can be called from more than one thread at a time.
+/// \ingroup ioda_cxx_engines_pub_HH
+IODA_DL bool isLibraryThreadSafe();
+
 /// stream operator
 IODA_DL std::ostream& operator<<(std::ostream& os, const HDF5_Version& ver);
 /// stream operator
@@ -13,6 +13,7 @@
  * \brief ObsStore engine
  */
 #pragma once
+#include <cstddef>
 #include <string>
 
 #include "../defs.h"
@@ -23,10 +24,29 @@ class Group;
 
 namespace Engines {
 namespace ObsStore {
+/// \brief Options controlling where an ObsStore keeps the values of its Variables.
+/// \ingroup ioda_cxx_engines_pub_ObsStore
+struct StorageOptions {
+  /// \brief Directory holding the scratch files backing memory-mapped Variables.
+  /// \details If empty, all Variables are kept in ordinary (heap) memory. Otherwise, Variables
+  ///   of fixed-size types whose values outgrow mappedThreshold are moved to a memory-mapped
+  ///   scratch file in this directory (preferably on node-local tmpfs or NVMe storage), so
+  ///   that the operating system can page out values that are not being used. The files are
+  ///   unlinked as soon as they are created and disappear when the ObsStore is destroyed.
+  std::string scratchDirectory;
+  /// \brief Size (in bytes) above which the values of a Variable are memory-mapped.
+  std::size_t mappedThreshold = 16 * 1024 * 1024;
+};
+
 /// \brief Create a ioda::Group backed by an OsbStore Group object.
 /// \ingroup ioda_cxx_engines_pub_ObsStore
 IODA_DL Group createRootGroup();
 
+/// \brief Create a ioda::Group backed by an OsbStore Group object.
+/// \param options describes where the values of Variables are kept.
+/// \ingroup ioda_cxx_engines_pub_ObsStore
+IODA_DL Group createRootGroup(const StorageOptions& options);
+
 /// \brief Get capabilities of the ObsStore engine
 /// \ingroup ioda_cxx_engines_pub_ObsStore
 IODA_DL Capabilities getCapabilities();
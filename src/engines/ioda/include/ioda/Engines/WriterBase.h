@@ -66,7 +66,10 @@ class WriterParametersWrapper : public oops::Parameters {
 class WriterCreationParameters {
   public:
     WriterCreationParameters(const eckit::mpi::Comm & comm, const eckit::mpi::Comm & timeComm,
-                             const bool createMultipleFiles, const bool isParallelIo);
+                             const bool createMultipleFiles, const bool isParallelIo,
+                             const std::size_t chunkCacheSize = 0,
+                             const std::size_t maxFileSize = 0,
+                             const bool updateExistingFile = false);
     virtual ~WriterCreationParameters() {}
 
     /// \brief io pool communicator group
@@ -88,6 +91,20 @@ class WriterCreationParameters {
     /// that the multiple files created by the io pool should be concatenated together
     /// in the IoPool::finalize() function.
     const bool isParallelIo;
+
+    /// \brief size in bytes of the chunk cache of the output file (0 -> backend default)
+    const std::size_t chunkCacheSize;
+
+    /// \brief maximum size in bytes of each output file (0 -> no limit)
+    /// \details Backends that support it split the output into a set of files no
+    /// larger than this size.
+    const std::size_t maxFileSize;
+
+    /// \brief flag indicating that the output file of an earlier save is to be opened
+    /// for update rather than a new file created
+    /// \details The io pool sets this flag when only the variables modified since the
+    /// previous save are to be written.
+    const bool updateExistingFile;
 };
 
 //----------------------------------------------------------------------------------------
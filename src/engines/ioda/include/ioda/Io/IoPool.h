@@ -26,6 +26,7 @@
 #include "ioda/Engines/WriterBase.h"
 #include "ioda/Group.h"
 #include "ioda/Io/IoPoolParameters.h"
+#include "ioda/Io/WriterUtils.h"
 
 #include "oops/util/DateTime.h"
 #include "oops/util/parameters/Parameters.h"
@@ -100,14 +101,48 @@ public:
   /// \brief return the rank assignment for this object.
   const std::vector<std::pair<int, int>> & rank_assignment() const { return rank_assignment_; }
 
+  /// \brief return true if string variables are written as fixed-length strings
+  /// \details Strings are written as variable-length strings unless the output file is
+  /// written in parallel mode with an HDF5 library that cannot write variable-length data
+  /// in that mode. This flag is set consistently on all ranks in the comm_all_ group.
+  const bool fixed_length_strings() const { return fixed_length_strings_; }
+
+  /// \brief return the maximum size in bytes of the blocks of variable data sent to
+  /// the io pool ranks
+  const std::size_t max_buffer_size() const { return params_.value().maxBufferSize; }
+
+  /// \brief return the chunk size in bytes for the output variables (0 if not set)
+  const std::size_t chunk_size() const {
+      return params_.value().chunkSize.value() != boost::none ?
+          *params_.value().chunkSize.value() : 0;
+  }
+
+  /// \brief return true if the ranks outside the io pool return from save without waiting
+  /// for their data to be transferred
+  const bool is_asynchronous() const { return params_.value().asynchronous; }
+
   /// \brief save obs data to output file
   /// \param srcGroup source ioda group to be saved into the output file
+  /// \detail In asynchronous mode the ranks outside the io pool return as soon as their
+  /// data are on their way to the io pool, and the transfers are completed by finalize().
   void save(const Group & srcGroup);
 
+  /// \brief update the output file of an earlier save
+  /// \detail The output file written by an earlier save of the same obs space layout is
+  /// opened for update, and only the variables listed in varNames are written to it.
+  /// Variables not yet in the file are created. The list must be the same on all ranks.
+  /// If the file was written with fixed length strings, the whole file is saved instead.
+  /// \param srcGroup source ioda group to be saved into the output file
+  /// \param varNames names of the variables in srcGroup to be written
+  void update(const Group & srcGroup, const std::vector<std::string> & varNames);
+
   /// \brief finalize the io pool before destruction
   /// \detail This routine is here to do specialized clean up after the save function has been
-  /// called and before the destructor is called. The primary task is to clean up the eckit
-  /// split communicator groups.
+  /// called and before the destructor is called. In asynchronous mode this is where the
+  /// ranks outside the io pool wait for their transfers to complete, and where the io pool
+  /// ranks wait for each other to finish writing. The eckit split communicator groups are
+  /// cleaned up by the destructor, so that finalize() can be called from a thread other
+  /// than the one that constructed the io pool.
   void finalize();
 
   /// \brief fill in print routine for the util::Printable base class
@@ -135,6 +170,10 @@ private:
   /// \brief mulitiple files flag, true -> will be creating a set of output files
   bool create_multiple_files_;
 
+  /// \brief fixed length strings flag, true -> string variables are written as fixed
+  /// length strings and converted to variable length strings by finalize()
+  bool fixed_length_strings_;
+
   /// \brief target pool size
   int target_pool_size_;
 
@@ -183,6 +222,18 @@ private:
   /// \brief writer engine destination for printing (eg, output file name)
   std::string writerDest_;
 
+  /// \brief names of the split communicator groups (unique to this instance)
+  /// \detail Several io pools can exist at the same time in asynchronous mode, so each
+  /// instance needs its own communicator names.
+  std::string pool_comm_name_;
+  std::string non_pool_comm_name_;
+
+  /// \brief sends to the io pool that have not been completed yet (asynchronous mode)
+  PendingSends pending_sends_;
+
+  /// \brief true once finalize() has run
+  bool finalized_;
+
   /// \brief ranks in the all_comm_ group that this rank transfers data
   /// \detail Each pair in this vector contains as the first element the rank number
   /// it is assigned and as the second element the number of locations for the assigned
@@ -202,6 +253,15 @@ private:
   /// \param rankGrouping structure that maps ranks outside the pool to ranks in the pool
   void groupRanks(IoPoolGroupMap & rankGrouping);
 
+  /// \brief group ranks into sets for the io pool assignments according to node placement
+  /// \detail This function finds the ranks sharing each node (using MPI_Comm_split_type),
+  /// gathers consecutive nodes into groups of "nodes per pool task" nodes and assigns the
+  /// lowest rank of each group to the io pool. The other ranks of the group are associated
+  /// with that pool rank, so the data transfers stay within the group of nodes. This
+  /// function also sets the data member target_pool_size_ to the number of groups.
+  /// \param rankGrouping structure that maps ranks outside the pool to ranks in the pool
+  void groupRanksByNode(IoPoolGroupMap & rankGrouping);
+
   /// \brief assign ranks in the comm_all_ comm group to each of the ranks in the io pool
   /// \detail This function will dole out the ranks within the comm_all_ group, that are
   /// not in the io pool, to the ranks that are in the io pool. This sets up the send/recv
@@ -235,10 +295,15 @@ private:
   /// to the nlocs dimension when writing to a single output file.
   void collectSingleFileInfo();
 
+  /// \brief create (or open for update) the output file on this io pool rank
+  /// \param updateExistingFile when true open the file of an earlier save for update
+  Group openOutputFile(const bool updateExistingFile);
+
   /// \brief create file names for the fixed length string workaround
   /// \details The workaround entails moving the newly written file name to a temporary
   /// file and then copying the temp file back to the intended file name while changing
-  /// the fixed length strings to variable length strings.
+  /// the fixed length strings to variable length strings. It is only needed when the
+  /// fixed_length_strings_ flag is set.
   /// \param finalFileName final (intended) output file name
   /// \param tempFileName temporary output file name
   void workaroundGenFileNames(std::string & finalFileName, std::string & tempFileName);
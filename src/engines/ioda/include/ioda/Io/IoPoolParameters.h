@@ -39,15 +39,44 @@ class IoPoolParameters : public oops::Parameters {
     /// maximum pool size in number of MPI processes
     oops::Parameter<int> maxPoolSize{"max pool size", -1, this};
 
+    /// return from save on the tasks outside the io pool without waiting for the write
+    /// \details When true, the tasks outside the io pool pack all of their data, post the
+    /// sends to their io pool task and return from save straight away, leaving the io pool
+    /// tasks to write the file in the meantime. The sends are completed (and the send
+    /// buffers released) when the io pool is finalized. This needs memory for a full copy
+    /// of the data on the tasks outside the io pool.
+    oops::Parameter<bool> asynchronous{"asynchronous", false, this};
+
+    /// place the io pool tasks according to the node topology
+    /// \details When true, one io pool task is placed on each group of "nodes per pool task"
+    /// nodes and collects the data from the other tasks in that group of nodes. The pool
+    /// size then follows the number of nodes, and is only capped by "max pool size" if
+    /// that is set explicitly.
+    oops::Parameter<bool> topologyAware{"topology aware", false, this};
+
+    /// number of nodes served by each io pool task (when "topology aware" is true)
+    oops::Parameter<int> nodesPerPoolTask{"nodes per pool task", 1, this};
+
     /// chunk size in bytes
+    /// \details Variables using the nlocs dimension are written in chunks holding this
+    /// many bytes worth of locations, and a single element along their other dimensions.
     oops::OptionalParameter<std::size_t> chunkSize{"chunk size", this};
 
     /// chunk cache size in bytes
     oops::OptionalParameter<std::size_t> chunkCacheSize{"chunk cache size", this};
 
     /// maximum file size in megabytes
+    /// \details When set, each output file is written as a family of files no larger
+    /// than this size, named by inserting "_part%04d" in front of the file extension.
+    /// This name can be used as the input file name to read the family back in. Not
+    /// available when writing a single output file in parallel mode.
     oops::OptionalParameter<std::size_t> maxFileSize{"max file size", this};
 
+    /// maximum size in bytes of the blocks of variable data sent to an io pool task
+    /// \details An io pool task holds at most two blocks from each of its assigned tasks
+    /// at any time. A variable larger than this is sent in a block of its own.
+    oops::Parameter<std::size_t> maxBufferSize{"max buffer size", 64 * 1024 * 1024, this};
+
     /// write multiple files (write one file per io pool task)
     /// default is false meaning a single output file will be written
     oops::Parameter<bool> writeMultipleFiles{"write multiple files", false, this};
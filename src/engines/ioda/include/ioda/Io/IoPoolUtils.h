@@ -28,6 +28,20 @@ namespace ioda {
   std::string uniquifyFileName(const std::string & fileName, std::size_t rankNum,
                                int timeRankNum);
 
+  /// \brief create the name of a file family from the output file name
+  /// \details This function will insert a member number conversion ("_part%04d") in front
+  /// of the file extension, and escape any percent signs already in the file name. The
+  /// resulting name can be given as the input file name to the reader, which will then
+  /// open all of the members as a single file.
+  /// \param fileName output file name
+  std::string familyFileName(const std::string & fileName);
+
+  /// \brief can the output file be written on a background thread?
+  /// \details This requires the MPI library to have been initialized with full thread
+  /// support (MPI_THREAD_MULTIPLE) and the HDF5 library to have been built thread safe,
+  /// since the main thread carries on making MPI and HDF5 calls during the write.
+  bool canSaveInBackground();
+
 }  // namespace ioda
 
 /// @}
@@ -12,21 +12,54 @@
 #include <gsl/gsl-lite.hpp>
 #include <memory>
 #include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "eckit/mpi/Comm.h"
+
 #include "ioda/defs.h"
 
 namespace ioda {
     class Group;
     class IoPool;
 
+/// @brief Sends of variable data to the io pool that have not been completed yet
+/// @details The buffers must be kept until the requests are complete.
+struct PendingSends {
+    std::vector<std::vector<std::size_t>> manifests;
+    std::vector<std::vector<char>> buffers;
+    std::vector<eckit::mpi::Request> requests;
+};
+
 /// @brief Transfer group contents from in memory group to a file group using an io pool
 /// @param ioPool ioda IoPool object
 /// @param memGroup is the source in memory group
 /// @param fileGroup is the destination file group
 /// @param isParallelIo true if writing the output file in parallel IO mode
+/// @param fixedLengthStrings true if string variables are to be written as fixed length
+///        strings (otherwise they are written as variable length strings)
+/// @param pendingSends if not null, the ranks outside the io pool return as soon as their
+///        data have been packed and the sends posted. The send buffers and requests are
+///        added to pendingSends, and the caller must wait for the requests to complete.
 IODA_DL void ioWriteGroup(const ioda::IoPool & ioPool, const ioda::Group& memGroup,
-                          ioda::Group& fileGroup, const bool isParallelIo);
+                          ioda::Group& fileGroup, const bool isParallelIo,
+                          const bool fixedLengthStrings = false,
+                          PendingSends * pendingSends = nullptr);
+
+/// @brief Transfer some variables from in memory group to an existing file group using
+///        an io pool
+/// @details The file group holds the output of an earlier ioWriteGroup call for the same
+///        io pool layout. The listed variables are written to it, and the ones not yet in
+///        the file group are created (along with their groups).
+/// @param ioPool ioda IoPool object
+/// @param memGroup is the source in memory group
+/// @param fileGroup is the destination file group
+/// @param varNames names of the variables to be transferred (the same on all ranks)
+/// @param isParallelIo true if writing the output file in parallel IO mode
+/// @param pendingSends see ioWriteGroup
+IODA_DL void ioUpdateGroup(const ioda::IoPool & ioPool, const ioda::Group& memGroup,
+                           ioda::Group& fileGroup, const std::vector<std::string> & varNames,
+                           const bool isParallelIo, PendingSends * pendingSends = nullptr);
 
 }  // namespace ioda
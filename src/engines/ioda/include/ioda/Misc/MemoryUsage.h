@@ -0,0 +1,62 @@
+#pragma once
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+/*! \addtogroup ioda_cxx_variable
+ * @{
+ * \file MemoryUsage.h
+ * \brief Describe the memory used by ioda::Variable objects.
+ */
+#include <cstddef>
+#include <map>
+#include <string>
+
+#include "ioda/defs.h"
+
+namespace ioda {
+/// \brief Memory held by a Variable in a backend that keeps its data in memory.
+/// \ingroup ioda_cxx_variable
+struct MemoryUsage {
+  std::size_t dataBytes       = 0;  ///< Bytes holding the elements currently stored.
+  std::size_t slackBytes      = 0;  ///< Bytes allocated but unused (capacity beyond size).
+  std::size_t stringHeapBytes = 0;  ///< Heap buffers of strings too long to be stored inline.
+  std::size_t attributeBytes  = 0;  ///< Bytes used by the Variable's attributes.
+  std::size_t mappedBytes     = 0;  ///< Bytes held in file-backed mappings (can be paged out).
+
+  /// The total number of bytes.
+  std::size_t total() const {
+    return dataBytes + slackBytes + stringHeapBytes + attributeBytes + mappedBytes;
+  }
+
+  MemoryUsage& operator+=(const MemoryUsage& other) {
+    dataBytes += other.dataBytes;
+    slackBytes += other.slackBytes;
+    stringHeapBytes += other.stringHeapBytes;
+    attributeBytes += other.attributeBytes;
+    mappedBytes += other.mappedBytes;
+    return *this;
+  }
+};
+
+/// \brief Memory used by each Variable of a Group, indexed by the full Variable name.
+/// \ingroup ioda_cxx_variable
+typedef std::map<std::string, MemoryUsage> MemoryReport;
+
+/// \brief Sum the entries of a MemoryReport over the Variables of each Group.
+/// \details The result is indexed by Group name (the part of each Variable name
+///   before the last '/', or an empty string for Variables in the top-level Group).
+/// \ingroup ioda_cxx_variable
+inline std::map<std::string, MemoryUsage> aggregateByGroup(const MemoryReport& report) {
+  std::map<std::string, MemoryUsage> res;
+  for (const auto& entry : report) {
+    const std::size_t pos = entry.first.rfind('/');
+    res[pos == std::string::npos ? std::string() : entry.first.substr(0, pos)] += entry.second;
+  }
+  return res;
+}
+}  // namespace ioda
+
+/// @}
@@ -18,6 +18,7 @@
 
 #include "./Group.h"
 #include "./Misc/DimensionScales.h"
+#include "./Misc/MemoryUsage.h"
 #include "./defs.h"
 
 namespace ioda {
@@ -68,6 +69,12 @@ public:
   ///
   void resize(const std::vector<std::pair<Variable, ioda::Dimensions_t>>& newDims);
 
+  /// \brief Report the memory used by every Variable in the ObsGroup.
+  /// \details The report is indexed by the full Variable name (e.g. "ObsValue/air_temperature").
+  ///   Backends that do not keep their data in memory report zero for every Variable.
+  ///   Attributes attached to Groups are not counted.
+  MemoryReport getMemoryReport() const;
+
 private:
   /// \brief recusively visit all groups and resize variables according
   /// to newDims.
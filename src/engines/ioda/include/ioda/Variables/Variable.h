@@ -27,6 +27,7 @@
 #include "ioda/Exception.h"
 #include "ioda/MathOps.h"
 #include "ioda/Misc/Eigen_Compat.h"
+#include "ioda/Misc/MemoryUsage.h"
 #include "ioda/Python/Var_ext.h"
 #include "ioda/Types/Marshalling.h"
 #include "ioda/Types/Type.h"
@@ -174,6 +175,11 @@ public:
   ///   2) PixelsPerBlock, and 3) general SZIP filter option flags.
   virtual std::tuple<bool, unsigned, unsigned> getSZIPCompression() const;
 
+  /// \brief Retrieve the memory used by the Variable's data and attributes.
+  /// \note Only backends that keep data in memory (e.g. ObsStore) report
+  ///   nonzero usage.
+  virtual MemoryUsage getMemoryUsage() const;
+
   /// @}
   /// @name Data Space-Querying Functions
   /// @{
@@ -902,6 +908,9 @@ public:
   VariableCreationParameters getCreationParameters(bool doAtts = true,
                                                    bool doDims = true) const override;
 
+  /// Default implementation, reporting no memory usage. Overridden by in-memory backends.
+  MemoryUsage getMemoryUsage() const override;
+
 protected:
   Variable_Backend();
 
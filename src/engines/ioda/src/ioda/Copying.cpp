@@ -195,4 +195,56 @@ void copyGroup(const ioda::Group & src, ioda::Group & dest) {
     dest.vars.attachDimensionScales(dimsAttachedToNewVars);
 }
 
+void copyGroup(const ioda::Group & src, ioda::Group & dest,
+               const std::vector<std::string> & varNames) {
+    const std::set<std::string> selectedVars(varNames.begin(), varNames.end());
+
+    // Copy the global attributes, and the groups holding the selected variables
+    copyAttributes(src.atts, dest.atts);
+    std::set<std::string> groupNames;
+    for (const auto & varName : selectedVars) {
+        for (std::size_t pos = varName.find('/'); pos != std::string::npos;
+             pos = varName.find('/', pos + 1)) {
+            groupNames.insert(varName.substr(0, pos));
+        }
+    }
+    for (const auto & groupName : groupNames) {
+        // The set is sorted, so parent groups are created before their children.
+        Group destGroup = dest.create(groupName);
+        Group srcGroup = src.open(groupName);
+        copyAttributes(srcGroup.atts, destGroup.atts);
+    }
+
+    VarUtils::Vec_Named_Variable varList, dimVarList;
+    VarUtils::VarDimMap dimsAttachedToVars;
+    Dimensions_t maxVarSize0;
+    VarUtils::collectVarDimInfo(src, varList, dimVarList, dimsAttachedToVars, maxVarSize0);
+
+    // Dimension variables
+    for (auto & namedVar : dimVarList) {
+        Variable destVar;
+        createAndCopyVariable(namedVar.name, namedVar.var, dest.vars, destVar);
+        destVar.setIsDimensionScale(namedVar.var.getDimensionScaleName());
+    }
+
+    // Selected regular variables
+    for (auto & namedVar : varList) {
+        if (selectedVars.count(namedVar.name) == 0) continue;
+        Variable destVar;
+        createAndCopyVariable(namedVar.name, namedVar.var, dest.vars, destVar);
+    }
+
+    std::vector<std::pair<Variable, std::vector<Variable>>> dimsAttachedToNewVars;
+    for (const auto &srcAttachment : dimsAttachedToVars) {
+      if (selectedVars.count(srcAttachment.first.name) == 0) continue;
+      Variable destVar = dest.vars[srcAttachment.first.name];
+      std::vector<Variable> newDims;
+      for (const auto &srcDim : srcAttachment.second) {
+          newDims.push_back(dest.vars[srcDim.name]);
+      }
+      dimsAttachedToNewVars.push_back(make_pair(destVar, std::move(newDims)));
+    }
+    dest.vars.attachDimensionScales(dimsAttachedToNewVars);
+}
+
 }  // namespace ioda
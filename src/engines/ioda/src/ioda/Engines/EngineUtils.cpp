@@ -190,15 +190,22 @@ Group constructBackend(BackendNames name, BackendCreationParameters& params) {
   Group backend;
   if (name == BackendNames::Hdf5File) {
     if (params.action == BackendFileActions::Open) {
-      return HH::openFile(params.fileName, params.openMode);
+      return HH::openFileImpl(params.fileName, params.openMode, HH::defaultVersionRange(),
+                 params.comm, false, params.chunkCacheSize);
+    }
+    if (params.action == BackendFileActions::OpenParallel) {
+      return HH::openFileImpl(params.fileName, params.openMode, HH::defaultVersionRange(),
+                 params.comm, true, params.chunkCacheSize);
     }
     if (params.action == BackendFileActions::Create) {
-      return HH::createFile(params.fileName, params.createMode,
-                 HH::HDF5_Version_Range(HH::HDF5_Version::V18, HH::HDF5_Version::V110));
+      return HH::createFileImpl(params.fileName, params.createMode,
+                 HH::HDF5_Version_Range(HH::HDF5_Version::V18, HH::HDF5_Version::V110),
+                 params.comm, false, params.chunkCacheSize, params.familyMemberSize);
     }
     if (params.action == BackendFileActions::CreateParallel) {
-      return HH::createParallelFile(params.fileName, params.createMode, params.comm,
-                 HH::HDF5_Version_Range(HH::HDF5_Version::V18, HH::HDF5_Version::V110));
+      return HH::createFileImpl(params.fileName, params.createMode,
+                 HH::HDF5_Version_Range(HH::HDF5_Version::V18, HH::HDF5_Version::V110),
+                 params.comm, true, params.chunkCacheSize, params.familyMemberSize);
     }
     throw Exception("Unknown BackendFileActions value", ioda_Here());
   }
@@ -214,7 +221,10 @@ Group constructBackend(BackendNames name, BackendCreationParameters& params) {
     throw Exception("Unknown BackendFileActions value", ioda_Here());
   }
   if (name == BackendNames::ObsStore) {
-    return ObsStore::createRootGroup();
+    ObsStore::StorageOptions options;
+    options.scratchDirectory = params.scratchDirectory;
+    options.mappedThreshold  = params.mappedThreshold;
+    return ObsStore::createRootGroup(options);
   }
 
   // If we get to here, then we have a backend name that is
@@ -13,6 +13,7 @@
 
 #include "ioda/Engines/HH.h"
 
+#include <cctype>
 #include <mutex>
 #include <random>
 #include <sstream>
@@ -83,6 +84,21 @@ HDF5_Version_Range defaultVersionRange() {
 #endif
 }
 
+namespace {
+/// Set the size in bytes of the raw data chunk cache in the file access property list \p plid,
+/// keeping the default number of slots and preemption policy.
+void setChunkCacheSize(hid_t plid, const std::size_t chunkCacheSize, const Options& errOpts) {
+  int mdcNelmts = 0;
+  size_t rdccNslots = 0;
+  size_t rdccNbytes = 0;
+  double rdccW0 = 0;
+  if (0 > H5Pget_cache(plid, &mdcNelmts, &rdccNslots, &rdccNbytes, &rdccW0))
+    throw Exception("H5Pget_cache failed", ioda_Here(), errOpts);
+  if (0 > H5Pset_cache(plid, mdcNelmts, rdccNslots, chunkCacheSize, rdccW0))
+    throw Exception("H5Pset_cache failed", ioda_Here(), errOpts);
+}
+}  // namespace
+
 Group createMemoryFile(const std::string& filename, BackendCreateModes mode, bool flush_on_close,
                        size_t increment_len, HDF5_Version_Range compat) {
   using namespace ioda::detail::Engines::HH;
@@ -131,7 +147,8 @@ Group createParallelFile(const std::string& filename, BackendCreateModes mode,
 }
 
 Group createFileImpl(const std::string& filename, BackendCreateModes mode,
-      HDF5_Version_Range compat, const MPI_Comm mpiComm, const bool isParallelIo) {
+      HDF5_Version_Range compat, const MPI_Comm mpiComm, const bool isParallelIo,
+      const std::size_t chunkCacheSize, const std::size_t familyMemberSize) {
   using namespace ioda::detail::Engines::HH;
 
   static const std::map<BackendCreateModes, unsigned int> m{
@@ -142,15 +159,27 @@ Group createFileImpl(const std::string& filename, BackendCreateModes mode,
   errOpts.add("filename", filename);
   errOpts.add("mode", mode);
   errOpts.add("compat", compat);
+  errOpts.add("chunkCacheSize", chunkCacheSize);
+  errOpts.add("familyMemberSize", familyMemberSize);
 
   hid_t plid = H5Pcreate(H5P_FILE_ACCESS);
   if (plid < 0) throw Exception("H5Pcreate failed", ioda_Here(), errOpts);
+  HH_hid_t pl(plid, Handles::Closers::CloseHDF5PropertyList::CloseP);
   if (isParallelIo) {
+    if (familyMemberSize > 0)
+      throw Exception("File families cannot be written in parallel access mode",
+                      ioda_Here(), errOpts);
     herr_t rc = H5Pset_fapl_mpio(plid, mpiComm, MPI_INFO_NULL);
     if (rc < 0) throw Exception("H5Pset_fapl_mpio failed", ioda_Here(), errOpts);
+  } else if (familyMemberSize > 0) {
+    if (!isFamilyFileName(filename))
+      throw Exception("The name of a file family must contain an integer conversion",
+                      ioda_Here(), errOpts);
+    if (0 > H5Pset_fapl_family(plid, static_cast<hsize_t>(familyMemberSize), H5P_DEFAULT))
+      throw Exception("H5Pset_fapl_family failed", ioda_Here(), errOpts);
   }
+  if (chunkCacheSize > 0) setChunkCacheSize(plid, chunkCacheSize, errOpts);
 
-  HH_hid_t pl(plid, Handles::Closers::CloseHDF5PropertyList::CloseP);
   // H5F_LIBVER_V18, H5F_LIBVER_V110, H5F_LIBVER_V112, H5F_LIBVER_LATEST.
   // Note: this propagates to any files flushed to disk.
   if (0 > H5Pset_libver_bounds(pl.get(), map_h5ver.at(compat.first), map_h5ver.at(compat.second)))
@@ -165,6 +194,14 @@ Group createFileImpl(const std::string& filename, BackendCreateModes mode,
 }
 
 Group openFile(const std::string& filename, BackendOpenModes mode, HDF5_Version_Range compat) {
+  // last argument is false signifying to open in single process access
+  MPI_Comm dummyComm;
+  return openFileImpl(filename, mode, compat, dummyComm, false);
+}
+
+Group openFileImpl(const std::string& filename, BackendOpenModes mode,
+      HDF5_Version_Range compat, const MPI_Comm mpiComm, const bool isParallelIo,
+      const std::size_t chunkCacheSize) {
   using namespace ioda::detail::Engines::HH;
   static const std::map<BackendOpenModes, unsigned int> m{
     {BackendOpenModes::Read_Only, H5F_ACC_RDONLY}, {BackendOpenModes::Read_Write, H5F_ACC_RDWR}};
@@ -173,10 +210,23 @@ Group openFile(const std::string& filename, BackendOpenModes mode, HDF5_Version_
   errOpts.add("filename", filename);
   errOpts.add("mode", mode);
   errOpts.add("compat", compat);
+  errOpts.add("chunkCacheSize", chunkCacheSize);
 
   hid_t plid = H5Pcreate(H5P_FILE_ACCESS);
   if (plid < 0) throw Exception("H5Pcreate failed", ioda_Here(), errOpts);
   HH_hid_t pl(plid, Handles::Closers::CloseHDF5PropertyList::CloseP);
+  if (isParallelIo) {
+    if (isFamilyFileName(filename))
+      throw Exception("File families cannot be opened in parallel access mode",
+                      ioda_Here(), errOpts);
+    herr_t rc = H5Pset_fapl_mpio(plid, mpiComm, MPI_INFO_NULL);
+    if (rc < 0) throw Exception("H5Pset_fapl_mpio failed", ioda_Here(), errOpts);
+  } else if (isFamilyFileName(filename)) {
+    // The member size of a file family is taken from the existing members.
+    if (0 > H5Pset_fapl_family(plid, H5F_FAMILY_DEFAULT, H5P_DEFAULT))
+      throw Exception("H5Pset_fapl_family failed", ioda_Here(), errOpts);
+  }
+  if (chunkCacheSize > 0) setChunkCacheSize(plid, chunkCacheSize, errOpts);
   if (0 > H5Pset_libver_bounds(pl.get(), map_h5ver.at(compat.first), map_h5ver.at(compat.second)))
     throw Exception("H5Pset_libver_bounds failed", ioda_Here(), errOpts);
 
@@ -189,6 +239,20 @@ Group openFile(const std::string& filename, BackendOpenModes mode, HDF5_Version_
   return ::ioda::Group{backend};
 }
 
+bool isFamilyFileName(const std::string& filename) {
+  for (std::size_t i = 0; i < filename.size(); ++i) {
+    if (filename[i] != '%') continue;
+    if (i + 1 < filename.size() && filename[i + 1] == '%') {
+      ++i;  // literal percent sign
+      continue;
+    }
+    std::size_t j = i + 1;
+    while (j < filename.size() && std::isdigit(static_cast<unsigned char>(filename[j]))) ++j;
+    if (j < filename.size() && filename[j] == 'd') return true;
+  }
+  return false;
+}
+
 Group openMemoryFile(const std::string& filename, BackendOpenModes mode, bool flush_on_close,
                      size_t increment_len, HDF5_Version_Range compat) {
   using namespace ioda::detail::Engines::HH;
@@ -237,6 +301,21 @@ Capabilities getCapabilitiesFileEngine() {
   return caps;
 }
 
+bool canWriteVarLenStringsInParallel() {
+#if H5_VERSION_GE(1, 14, 3)
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool isLibraryThreadSafe() {
+  hbool_t threadSafe = 0;
+  if (H5is_library_threadsafe(&threadSafe) < 0)
+    throw Exception("H5is_library_threadsafe failed.", ioda_Here());
+  return threadSafe > 0;
+}
+
 Capabilities getCapabilitiesInMemoryEngine() {
   static Capabilities caps;
   static bool inited = false;
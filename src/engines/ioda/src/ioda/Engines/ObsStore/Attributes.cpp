@@ -77,6 +77,11 @@ std::shared_ptr<Attribute> Attribute::read(gsl::span<char> data, const Type & dt
   return shared_from_this();
 }
 
+MemoryUsage Attribute::memoryUsage() const {
+  if (attr_data_ == nullptr) return MemoryUsage();
+  return attr_data_->memoryUsage();
+}
+
 //*********************************************************************
 //                        Has_Attributes function
 //*********************************************************************
@@ -115,6 +120,14 @@ std::vector<std::string> Has_Attributes::list() const {
   }
   return attrList;
 }
+
+std::size_t Has_Attributes::memoryUsage() const {
+  std::size_t bytes = 0;
+  for (auto iattr = attributes_.begin(); iattr != attributes_.end(); ++iattr) {
+    bytes += iattr->second->memoryUsage().total();
+  }
+  return bytes;
+}
 }  // namespace ObsStore
 }  // namespace ioda
 
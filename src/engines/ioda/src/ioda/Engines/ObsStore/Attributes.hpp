@@ -63,6 +63,8 @@ public:
   /// \param data contiguous block of data to transfer
   /// \param dtype ObsStore Type
   std::shared_ptr<Attribute> read(gsl::span<char> data, const Type & dtype);
+  /// \brief returns the memory used by the attribute data
+  MemoryUsage memoryUsage() const;
 };
 
 /// \ingroup ioda_internals_engines_obsstore
@@ -102,6 +104,9 @@ public:
 
   /// \brief returns a list of the names of attributes in the container
   std::vector<std::string> list() const;
+
+  /// \brief returns the total number of bytes used by all attributes in the container
+  std::size_t memoryUsage() const;
 };
 #if defined(__INTEL_COMPILER)
 #  pragma warning(pop)
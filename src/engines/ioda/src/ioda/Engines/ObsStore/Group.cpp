@@ -13,6 +13,7 @@
 #include "./Group.hpp"
 
 #include <stdexcept>
+#include <utility>
 
 #include "./Variables.hpp"
 #include "ioda/defs.h"
@@ -83,6 +84,7 @@ std::shared_ptr<Group> Group::create(const std::string& name) {
     childGroup = this->open(pathSections[0]);
   } else {
     childGroup = std::make_shared<Group>();
+    childGroup->storage_options_ = storage_options_;
     childGroup->vars->setParentGroup(childGroup);
     child_groups_.insert(
       std::pair<std::string, std::shared_ptr<Group>>(pathSections[0], childGroup));
@@ -122,8 +124,10 @@ std::shared_ptr<Group> Group::open(const std::string& name, const bool throwIfNo
   return childGroup;
 }
 
-std::shared_ptr<Group> Group::createRootGroup() {
+std::shared_ptr<Group> Group::createRootGroup(
+    std::shared_ptr<const Engines::ObsStore::StorageOptions> options) {
   std::shared_ptr<Group> group = std::make_shared<Group>();
+  group->storage_options_ = std::move(options);
   group->vars->setParentGroup(group);
   return group;
 }
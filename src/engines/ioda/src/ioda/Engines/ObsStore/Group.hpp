@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "./Attributes.hpp"
+#include "ioda/Engines/ObsStore.h"
 
 namespace ioda {
 namespace ObsStore {
@@ -32,6 +33,9 @@ private:
   /// \brief container for child groups
   std::map<std::string, std::shared_ptr<Group>> child_groups_;
 
+  /// \brief options controlling where variable values are kept (shared by all groups of a tree)
+  std::shared_ptr<const Engines::ObsStore::StorageOptions> storage_options_;
+
   /// \brief split a path into the first level and remainder of the path
   /// \param path Hierarchical path
   static std::vector<std::string> splitFirstLevel(const std::string& path);
@@ -71,8 +75,15 @@ public:
   /// \param name name of child group
   std::shared_ptr<Group> open(const std::string& name, const bool throwIfNotFound = true);
 
+  /// \brief returns the options controlling where variable values are kept (may be null)
+  std::shared_ptr<const Engines::ObsStore::StorageOptions> storageOptions() const {
+    return storage_options_;
+  }
+
   /// \brief Creates a root group
-  static std::shared_ptr<Group> createRootGroup();
+  /// \param options controls where variable values are kept (null keeps them in heap memory)
+  static std::shared_ptr<Group> createRootGroup(
+    std::shared_ptr<const Engines::ObsStore::StorageOptions> options = nullptr);
 };
 }  // namespace ObsStore
 }  // namespace ioda
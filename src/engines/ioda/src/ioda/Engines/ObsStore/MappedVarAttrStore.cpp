@@ -0,0 +1,78 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+/*! \addtogroup ioda_internals_engines_obsstore
+ *
+ * @{
+ * \file MappedVarAttrStore.cpp
+ * \brief ObsStore variable data storage in memory-mapped scratch files
+ */
+
+#include "./MappedVarAttrStore.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "ioda/Exception.h"
+
+namespace ioda {
+namespace ObsStore {
+//------------------------------------------------------------------------------
+MappedRegion::MappedRegion(const std::string &directory)
+    : fd_(-1), data_(nullptr), capacity_(0) {
+  std::string pattern = directory + "/ioda-obsstore-XXXXXX";
+  std::vector<char> path(pattern.begin(), pattern.end());
+  path.push_back('\0');
+  fd_ = mkstemp(path.data());
+  if (fd_ < 0)
+    throw Exception("Unable to create a scratch file for a memory-mapped variable", ioda_Here())
+      .add("directory", directory)
+      .add("error", std::strerror(errno));
+  // Unlink the file straight away so that it is removed even if the program crashes.
+  unlink(path.data());
+}
+
+MappedRegion::~MappedRegion() {
+  if (data_ != nullptr) munmap(data_, capacity_);
+  if (fd_ >= 0) close(fd_);
+}
+
+void MappedRegion::reserve(std::size_t numBytes) {
+  if (numBytes <= capacity_) return;
+
+  // Grow geometrically so that repeated small extensions do not remap every time.
+  const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  std::size_t newCapacity = std::max(numBytes, capacity_ + capacity_ / 2);
+  newCapacity = (newCapacity + pageSize - 1) / pageSize * pageSize;
+
+  if (ftruncate(fd_, static_cast<off_t>(newCapacity)) != 0)
+    throw Exception("Unable to extend the scratch file of a memory-mapped variable", ioda_Here())
+      .add("bytes", newCapacity)
+      .add("error", std::strerror(errno));
+
+  // Map the extended file before releasing the old mapping, so that the old mapping (and the
+  // data it gives access to) stays valid if mmap fails. Both map the same file, so nothing
+  // needs to be copied.
+  void *newData = mmap(nullptr, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (newData == MAP_FAILED)
+    throw Exception("Unable to map the scratch file of a variable", ioda_Here())
+      .add("bytes", newCapacity)
+      .add("error", std::strerror(errno));
+  if (data_ != nullptr) munmap(data_, capacity_);
+  data_     = static_cast<char *>(newData);
+  capacity_ = newCapacity;
+}
+
+}  // namespace ObsStore
+}  // namespace ioda
+
+/// @}
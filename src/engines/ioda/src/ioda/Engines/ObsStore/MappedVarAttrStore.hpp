@@ -0,0 +1,193 @@
+/*
+ * (C) Copyright 2022 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+/*! \addtogroup ioda_internals_engines_obsstore
+ *
+ * @{
+ * \file MappedVarAttrStore.hpp
+ * \brief ObsStore variable data storage in memory-mapped scratch files
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gsl/gsl-lite.hpp"
+
+#include "./Selection.hpp"
+#include "./VarAttrStore.hpp"
+#include "ioda/Engines/ObsStore.h"
+#include "ioda/Exception.h"
+
+namespace ioda {
+namespace ObsStore {
+/// \brief contiguous block of memory backed by an (unlinked) scratch file
+/// \ingroup ioda_internals_engines_obsstore
+class MappedRegion {
+private:
+  /// \brief file descriptor of the scratch file
+  int fd_;
+  /// \brief start of the mapping (null if nothing is mapped)
+  char *data_;
+  /// \brief number of bytes mapped (always a multiple of the page size)
+  std::size_t capacity_;
+
+public:
+  /// \brief create an empty scratch file in the given directory
+  /// \param directory directory holding the scratch file
+  explicit MappedRegion(const std::string &directory);
+  ~MappedRegion();
+
+  MappedRegion(const MappedRegion &) = delete;
+  MappedRegion &operator=(const MappedRegion &) = delete;
+
+  /// \brief grow the mapping to hold at least numBytes (existing contents are preserved)
+  /// \param numBytes requested size in bytes
+  void reserve(std::size_t numBytes);
+
+  /// \brief returns the start of the mapping
+  char *data() const { return data_; }
+
+  /// \brief returns the number of bytes mapped
+  std::size_t capacity() const { return capacity_; }
+};
+
+/// \brief data storage that keeps small variables in a vector and moves variables
+///        outgrowing a threshold to a memory-mapped scratch file
+/// \details Only used for fixed-size (trivially copyable) data types. The operating
+///          system can page out the values of mapped variables that are not being used.
+/// \ingroup ioda_internals_engines_obsstore
+template <typename DataType>
+class MappedVarAttrStore : public VarAttrStore_Base {
+  static_assert(std::is_trivially_copyable<DataType>::value,
+                "only trivially copyable types can be memory-mapped");
+
+private:
+  /// \brief data storage used while the variable is smaller than the threshold
+  std::vector<DataType> var_attr_data_;
+
+  /// \brief data storage used once the variable has outgrown the threshold
+  std::unique_ptr<MappedRegion> mapped_data_;
+
+  /// \brief number of values stored
+  std::size_t size_;
+
+  /// \brief number of elements in one data piece (for arrayed types)
+  std::size_t num_elements_;
+
+  /// \brief where and when to map the data
+  std::shared_ptr<const Engines::ObsStore::StorageOptions> options_;
+
+  /// \brief returns a pointer to the stored values
+  DataType *data() const {
+    if (mapped_data_ != nullptr) return reinterpret_cast<DataType *>(mapped_data_->data());
+    return const_cast<DataType *>(var_attr_data_.data());
+  }
+
+  /// \brief change the number of stored values, leaving any new values uninitialized
+  /// \param newCount new number of values
+  void reallocate(std::size_t newCount) {
+    const std::size_t newBytes = newCount * sizeof(DataType);
+    if (mapped_data_ == nullptr && newBytes > options_->mappedThreshold) {
+      // Move the existing values to a new scratch file and release the heap memory.
+      mapped_data_.reset(new MappedRegion(options_->scratchDirectory));
+      mapped_data_->reserve(newBytes);
+      if (size_ > 0)
+        std::memcpy(mapped_data_->data(), var_attr_data_.data(),
+                    std::min(size_, newCount) * sizeof(DataType));
+      std::vector<DataType>().swap(var_attr_data_);
+    } else if (mapped_data_ != nullptr) {
+      mapped_data_->reserve(newBytes);
+    } else {
+      var_attr_data_.resize(newCount);
+    }
+    size_ = newCount;
+  }
+
+public:
+  MappedVarAttrStore(const std::size_t numElements,
+                     std::shared_ptr<const Engines::ObsStore::StorageOptions> options)
+      : size_(0), num_elements_(numElements), options_(std::move(options)) {}
+  ~MappedVarAttrStore() {}
+
+  /// \brief resizes memory allocated for data storage
+  /// \param newSize new size for allocated memory in number of vector elements
+  void resize(std::size_t newSize) override {
+    const std::size_t oldCount = size_;
+    reallocate(newSize * num_elements_);
+    if (size_ > oldCount) std::fill(data() + oldCount, data() + size_, DataType());
+  }
+
+  /// \brief resizes memory allocated for data storage
+  /// \param newSize new size for allocated memory in number of vector elements
+  /// \param fillvalue new elements get initialized to fillValue
+  void resize(std::size_t newSize, gsl::span<char> &fillValue) override {
+    gsl::span<DataType> fv_span(reinterpret_cast<DataType *>(fillValue.data()), 1);
+    const DataType fv = fv_span[0];
+    const std::size_t oldCount = size_;
+    reallocate(newSize * num_elements_);
+    if (size_ > oldCount) std::fill(data() + oldCount, data() + size_, fv);
+  }
+
+  /// \brief returns the memory used by the data storage
+  MemoryUsage memoryUsage() const override {
+    MemoryUsage res;
+    if (mapped_data_ != nullptr) {
+      res.mappedBytes = mapped_data_->capacity();
+    } else {
+      res.dataBytes  = var_attr_data_.size() * sizeof(DataType);
+      res.slackBytes = (var_attr_data_.capacity() - var_attr_data_.size()) * sizeof(DataType);
+    }
+    return res;
+  }
+
+  /// \brief transfer data to data storage
+  /// \param data contiguous block of data to transfer
+  /// \param m_select Selection ojbect: how to select from data argument
+  /// \param f_select Selection ojbect: how to select to storage
+  void write(gsl::span<const char> data, Selection &m_select, Selection &f_select) override {
+    if (data.size() > 0) {
+      const DataType *d_ptr = reinterpret_cast<const DataType *>(data.data());
+      DataType *s_ptr = this->data();
+      // assumes m_select and f_select have same number of points
+      m_select.init_lin_indx();
+      f_select.init_lin_indx();
+      while (!m_select.end_lin_indx()) {
+        std::size_t m_indx = m_select.next_lin_indx() * num_elements_;
+        std::size_t f_indx = f_select.next_lin_indx() * num_elements_;
+        std::copy(d_ptr + m_indx, d_ptr + m_indx + num_elements_, s_ptr + f_indx);
+      }
+    }
+  }
+
+  /// \brief transfer data from data storage
+  /// \param data contiguous block of data to transfer
+  /// \param m_select Selection ojbect: how to select to data argument
+  /// \param f_select Selection ojbect: how to select from storage
+  void read(gsl::span<char> data, Selection &m_select, Selection &f_select) const override {
+    if (data.size() > 0) {
+      DataType *d_ptr = reinterpret_cast<DataType *>(data.data());
+      const DataType *s_ptr = this->data();
+      // assumes m_select and f_select have same number of points
+      m_select.init_lin_indx();
+      f_select.init_lin_indx();
+      while (!m_select.end_lin_indx()) {
+        std::size_t m_indx = m_select.next_lin_indx() * num_elements_;
+        std::size_t f_indx = f_select.next_lin_indx() * num_elements_;
+        std::copy(s_ptr + f_indx, s_ptr + f_indx + num_elements_, d_ptr + m_indx);
+      }
+    }
+  }
+};
+}  // namespace ObsStore
+}  // namespace ioda
+
+/// @}
@@ -79,6 +79,10 @@ std::tuple<bool, unsigned, unsigned> ObsStore_Variable_Backend::getSZIPCompressi
   return std::tuple<bool, unsigned, unsigned>(true, sz[0], sz[1]);
 }
 
+MemoryUsage ObsStore_Variable_Backend::getMemoryUsage() const {
+  return backend_->memoryUsage();
+}
+
 Dimensions ObsStore_Variable_Backend::getDimensions() const {
   // Convert to Dimensions types
   std::vector<Dimensions_t> iodaDims = backend_->get_dimensions();
@@ -77,6 +77,9 @@ public:
   /// \brief Get the fill value associated with the Variable.
   FillValueData_t getFillValue() const final;
 
+  /// \brief return the memory used by this variable's data and attributes
+  MemoryUsage getMemoryUsage() const final;
+
   /// \brief return dimensions of this variable
   Dimensions getDimensions() const final;
 
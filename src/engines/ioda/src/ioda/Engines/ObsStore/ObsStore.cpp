@@ -26,6 +26,12 @@ Group createRootGroup() {
   return ::ioda::Group{backend};
 }
 
+Group createRootGroup(const StorageOptions& options) {
+  auto backend = std::make_shared<ObsStore_Group_Backend>(
+    ioda::ObsStore::Group::createRootGroup(std::make_shared<const StorageOptions>(options)));
+  return ::ioda::Group{backend};
+}
+
 Capabilities getCapabilities() {
   static Capabilities caps;
   static bool inited = false;
@@ -15,13 +15,28 @@
 
 #include <exception>
 
+#include "./MappedVarAttrStore.hpp"
 #include "./Type.hpp"
 #include "ioda/Exception.h"
 
 namespace ioda {
 namespace ObsStore {
+namespace {
+// Create a store for values of a fixed-size type, memory-mapped if requested in options.
+template <typename DataType>
+VarAttrStore_Base *createFixedSizeStore(
+    std::size_t numElements,
+    const std::shared_ptr<const Engines::ObsStore::StorageOptions> & options) {
+  if (options != nullptr && !options->scratchDirectory.empty())
+    return new MappedVarAttrStore<DataType>(numElements, options);
+  return new VarAttrStore<DataType>(numElements);
+}
+}  // namespace
+
 //------------------------------------------------------------------------------
-VarAttrStore_Base *createVarAttrStore(const std::shared_ptr<Type> & dtype) {
+VarAttrStore_Base *createVarAttrStore(
+    const std::shared_ptr<Type> & dtype,
+    const std::shared_ptr<const Engines::ObsStore::StorageOptions> & options) {
   VarAttrStore_Base *newStore = nullptr;
 
   // Get the fundamental (base) type marker. In the case of an arrayed type,
@@ -41,39 +56,39 @@ VarAttrStore_Base *createVarAttrStore(const std::shared_ptr<Type> & dtype) {
   // Use the baseType value to determine which templated version of the data store
   // to instantiate.
   if (baseType == ObsTypes::FLOAT) {
-    newStore = new VarAttrStore<float>(numElements);
+    newStore = createFixedSizeStore<float>(numElements, options);
   } else if (baseType == ObsTypes::DOUBLE) {
-    newStore = new VarAttrStore<double>(numElements);
+    newStore = createFixedSizeStore<double>(numElements, options);
   } else if (baseType == ObsTypes::LDOUBLE) {
-    newStore = new VarAttrStore<long double>(numElements);
+    newStore = createFixedSizeStore<long double>(numElements, options);
   } else if (baseType == ObsTypes::SCHAR) {
-    newStore = new VarAttrStore<signed char>(numElements);
+    newStore = createFixedSizeStore<signed char>(numElements, options);
   } else if (baseType == ObsTypes::SHORT) {
-    newStore = new VarAttrStore<short>(numElements);
+    newStore = createFixedSizeStore<short>(numElements, options);
   } else if (baseType == ObsTypes::INT) {
-    newStore = new VarAttrStore<int>(numElements);
+    newStore = createFixedSizeStore<int>(numElements, options);
   } else if (baseType == ObsTypes::LONG) {
-    newStore = new VarAttrStore<long>(numElements);
+    newStore = createFixedSizeStore<long>(numElements, options);
   } else if (baseType == ObsTypes::LLONG) {
-    newStore = new VarAttrStore<long long>(numElements);
+    newStore = createFixedSizeStore<long long>(numElements, options);
   } else if (baseType == ObsTypes::UCHAR) {
-    newStore = new VarAttrStore<unsigned char>(numElements);
+    newStore = createFixedSizeStore<unsigned char>(numElements, options);
   } else if (baseType == ObsTypes::USHORT) {
-    newStore = new VarAttrStore<unsigned short>(numElements);
+    newStore = createFixedSizeStore<unsigned short>(numElements, options);
   } else if (baseType == ObsTypes::UINT) {
-    newStore = new VarAttrStore<unsigned int>(numElements);
+    newStore = createFixedSizeStore<unsigned int>(numElements, options);
   } else if (baseType == ObsTypes::ULONG) {
-    newStore = new VarAttrStore<unsigned long>(numElements);
+    newStore = createFixedSizeStore<unsigned long>(numElements, options);
   } else if (baseType == ObsTypes::ULLONG) {
-    newStore = new VarAttrStore<unsigned long long>(numElements);
+    newStore = createFixedSizeStore<unsigned long long>(numElements, options);
   } else if (baseType == ObsTypes::CHAR) {
-    newStore = new VarAttrStore<char>(numElements);
+    newStore = createFixedSizeStore<char>(numElements, options);
   } else if (baseType == ObsTypes::WCHAR) {
-    newStore = new VarAttrStore<wchar_t>(numElements);
+    newStore = createFixedSizeStore<wchar_t>(numElements, options);
   } else if (baseType == ObsTypes::CHAR16) {
-    newStore = new VarAttrStore<char16_t>(numElements);
+    newStore = createFixedSizeStore<char16_t>(numElements, options);
   } else if (baseType == ObsTypes::CHAR32) {
-    newStore = new VarAttrStore<char32_t>(numElements);
+    newStore = createFixedSizeStore<char32_t>(numElements, options);
   } else if (baseType == ObsTypes::STRING) {
     newStore = new VarAttrStore<std::string>(numElements);
   } else
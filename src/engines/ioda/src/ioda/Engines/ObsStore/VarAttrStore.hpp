@@ -12,6 +12,7 @@
  */
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -19,7 +20,9 @@
 
 #include "./Selection.hpp"
 #include "./Type.hpp"
+#include "ioda/Engines/ObsStore.h"
 #include "ioda/Exception.h"
+#include "ioda/Misc/MemoryUsage.h"
 
 namespace ioda {
 namespace ObsStore {
@@ -47,6 +50,8 @@ public:
   /// \param m_select Selection ojbect: how to select to data argument
   /// \param f_select Selection ojbect: how to select from storage vector
   virtual void read(gsl::span<char> data, Selection &m_select, Selection &f_select) const = 0;
+  /// \brief returns the memory used by the data storage
+  virtual MemoryUsage memoryUsage() const = 0;
 };
 
 // Templated versions for each data type
@@ -77,6 +82,14 @@ public:
     var_attr_data_.resize(newSize * num_elements_, fv_span[0]);
   }
 
+  /// \brief returns the memory used by the data storage
+  MemoryUsage memoryUsage() const override {
+    MemoryUsage res;
+    res.dataBytes  = var_attr_data_.size() * sizeof(DataType);
+    res.slackBytes = (var_attr_data_.capacity() - var_attr_data_.size()) * sizeof(DataType);
+    return res;
+  }
+
   /// \brief transfer data to data storage vector
   /// \param data contiguous block of data to transfer
   /// \param m_select Selection ojbect: how to select from data argument
@@ -152,6 +165,19 @@ public:
     var_attr_data_.resize(newSize * num_elements_, fv_span[0]);
   }
 
+  /// \brief returns the memory used by the data storage
+  /// \details Strings short enough to fit in the std::string object itself (small-string
+  ///          optimization) use no heap memory; longer ones are counted in stringHeapBytes.
+  MemoryUsage memoryUsage() const override {
+    const std::size_t inlineCapacity = std::string().capacity();
+    MemoryUsage res;
+    res.dataBytes  = var_attr_data_.size() * sizeof(std::string);
+    res.slackBytes = (var_attr_data_.capacity() - var_attr_data_.size()) * sizeof(std::string);
+    for (const std::string &str : var_attr_data_)
+      if (str.capacity() > inlineCapacity) res.stringHeapBytes += str.capacity() + 1;
+    return res;
+  }
+
   /// \brief transfer data to data storage vector
   /// \param data contiguous block of data to transfer
   /// \param m_select Selection object: how to select from data argument
@@ -211,8 +237,13 @@ public:
 };
 
 /// \brief factory style function to create a new templated object
+/// \param dtype ObsStore data type
+/// \param options if set (and naming a scratch directory), values of fixed-size types
+///   are moved to a memory-mapped scratch file once they outgrow the threshold
 /// \ingroup ioda_internals_engines_obsstore
-VarAttrStore_Base *createVarAttrStore(const std::shared_ptr<Type> & dtype);
+VarAttrStore_Base *createVarAttrStore(
+  const std::shared_ptr<Type> & dtype,
+  const std::shared_ptr<const Engines::ObsStore::StorageOptions> & options = nullptr);
 
 }  // namespace ObsStore
 }  // namespace ioda
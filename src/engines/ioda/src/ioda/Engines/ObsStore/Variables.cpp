@@ -28,7 +28,8 @@ namespace ObsStore {
 Variable::Variable(const std::vector<Dimensions_t>& dimensions,
                    const std::vector<Dimensions_t>& max_dimensions,
                    const std::shared_ptr<Type> dtype,
-                   const VarCreateParams& params)
+                   const VarCreateParams& params,
+                   const std::shared_ptr<const Engines::ObsStore::StorageOptions>& storageOptions)
     : dimensions_(dimensions),
       max_dimensions_(max_dimensions),
       dtype_(std::move(dtype)),
@@ -37,7 +38,7 @@ Variable::Variable(const std::vector<Dimensions_t>& dimensions,
       atts(std::make_shared<Has_Attributes>()),
       impl_atts(std::make_shared<Has_Attributes>()) {
   // Get a typed storage object based on dtype
-  var_data_.reset(createVarAttrStore(dtype_));
+  var_data_.reset(createVarAttrStore(dtype_, storageOptions));
 
   // If have a fill value, save in an attribute. Do this before resizing
   // because resize() will check for the fill value.
@@ -146,6 +147,14 @@ std::shared_ptr<Variable> Variable::read(gsl::span<char> data, const Type & dtyp
   return shared_from_this();
 }
 
+MemoryUsage Variable::memoryUsage() const {
+  MemoryUsage res;
+  if (var_data_ != nullptr) res = var_data_->memoryUsage();
+  if (atts != nullptr) res.attributeBytes += atts->memoryUsage();
+  if (impl_atts != nullptr) res.attributeBytes += impl_atts->memoryUsage();
+  return res;
+}
+
 //***************************************************************************
 // Has_Variable methods
 //****************************************************************************
@@ -167,7 +176,10 @@ std::shared_ptr<Variable> Has_Variables::create(const std::string& name,
     var = group->vars->create(splitPaths[1], dtype, dims, max_dims, params);
   } else {
     // No intermediate groups, create variable here
-    var = std::make_shared<Variable>(dims, max_dims, dtype, params);
+    std::shared_ptr<const Engines::ObsStore::StorageOptions> storageOptions;
+    if (std::shared_ptr<Group> parentGroup = parent_group_.lock())
+      storageOptions = parentGroup->storageOptions();
+    var = std::make_shared<Variable>(dims, max_dims, dtype, params, storageOptions);
     variables_.insert(std::pair<std::string, std::shared_ptr<Variable>>(name, var));
   }
   return var;
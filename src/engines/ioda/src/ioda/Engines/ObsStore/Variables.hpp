@@ -22,6 +22,7 @@
 #include "./Selection.hpp"
 #include "./Type.hpp"
 #include "./VarAttrStore.hpp"
+#include "ioda/Engines/ObsStore.h"
 #include "ioda/Variables/Fill.h"
 #include "ioda/defs.h"
 
@@ -69,10 +70,14 @@ private:
 
 public:
   Variable() : atts(std::make_shared<Has_Attributes>()) {}
+  /// \param storageOptions controls where the variable values are kept
+  ///   (null keeps them in heap memory)
   Variable(const std::vector<Dimensions_t>& dimensions,
            const std::vector<Dimensions_t>& max_dimensions,
            const std::shared_ptr<Type> dtype,
-           const VarCreateParams& params);
+           const VarCreateParams& params,
+           const std::shared_ptr<const Engines::ObsStore::StorageOptions>& storageOptions
+             = nullptr);
   ~Variable() {}
 
   /// \brief container for variable attributes
@@ -139,6 +144,9 @@ public:
   /// \param f_select Selection ojbect: how to select from variable storage
   std::shared_ptr<Variable> read(gsl::span<char> data, const Type & dtype,
                                  Selection & m_select, Selection & f_select);
+
+  /// \brief returns the memory used by the variable data and attributes
+  MemoryUsage memoryUsage() const;
 };
 
 class Group;
@@ -56,8 +56,20 @@ WriteH5File::WriteH5File(const Parameters_ & params,
         outFileName = uniquifyFileName(params_.fileName, 0, mpiTimeRank);
     }
 
+    // Write a file family if the output is to be split into files of limited size.
+    // File families can't be written in parallel mode.
+    if ((createParams_.maxFileSize > 0) && (!createParams_.isParallelIo)) {
+        outFileName = familyFileName(outFileName);
+        oops::Log::info() << "ioda::Engines::WriteH5File: writing output file family: "
+                          << outFileName << std::endl;
+    }
+
     Engines::BackendCreationParameters backendParams;
     backendParams.fileName = outFileName;
+    backendParams.chunkCacheSize = createParams_.chunkCacheSize;
+    if (!createParams_.isParallelIo) {
+        backendParams.familyMemberSize = createParams_.maxFileSize;
+    }
     if (createParams_.isParallelIo) {
         backendParams.action = Engines::BackendFileActions::CreateParallel;
         backendParams.comm = 
@@ -65,6 +77,15 @@ WriteH5File::WriteH5File(const Parameters_ & params,
     } else {
         backendParams.action = Engines::BackendFileActions::Create;
     }
+    // Reopen the file written by an earlier save to update some of its variables.
+    if (createParams_.updateExistingFile) {
+        if (createParams_.isParallelIo) {
+            backendParams.action = Engines::BackendFileActions::OpenParallel;
+        } else {
+            backendParams.action = Engines::BackendFileActions::Open;
+        }
+        backendParams.openMode = Engines::BackendOpenModes::Read_Write;
+    }
     if (params.allowOverwrite) {
         backendParams.createMode = Engines::BackendCreateModes::Truncate_If_Exists;
     } else {
@@ -7,6 +7,7 @@
 
 #include "ioda/Engines/WriteOdbFile.h"
 
+#include "ioda/Exception.h"
 #include "ioda/Io/IoPoolUtils.h"
 
 #include "oops/util/Logger.h"
@@ -28,6 +29,10 @@ WriteOdbFile::WriteOdbFile(const Parameters_ & params,
                            const WriterCreationParameters & createParams)
                                : WriterBase(createParams), params_(params) {
     oops::Log::trace() << "ioda::Engines::WriteOdbFile start constructor" << std::endl;
+    if (createParams.updateExistingFile) {
+        throw Exception("The ODB writer cannot update an existing file", ioda_Here())
+            .add("obsfile", params.fileName.value());
+    }
     // TODO(srh) Placeholder for now. This gets the engine factory test to pass, but we may
     // actually want it organized like this as the writer gets developed.
 
@@ -22,10 +22,13 @@ namespace Engines {
 //---------------------------------------------------------------------
 WriterCreationParameters::WriterCreationParameters(const eckit::mpi::Comm & comm,
                           const eckit::mpi::Comm & timeComm, const bool createMultipleFiles,
-                          const bool isParallelIo)
+                          const bool isParallelIo, const std::size_t chunkCacheSize,
+                          const std::size_t maxFileSize, const bool updateExistingFile)
                               : comm(comm), timeComm(timeComm),
                                 createMultipleFiles(createMultipleFiles),
-                                isParallelIo(isParallelIo) {
+                                isParallelIo(isParallelIo), chunkCacheSize(chunkCacheSize),
+                                maxFileSize(maxFileSize),
+                                updateExistingFile(updateExistingFile) {
 }
 
 //---------------------------------------------------------------------
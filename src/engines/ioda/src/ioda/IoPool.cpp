@@ -5,13 +5,16 @@
  * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <memory>
 #include <mpi.h>
 #include <numeric>
 #include <sstream>
+#include <string>
 
 #include "eckit/config/LocalConfiguration.h"
+#include "eckit/mpi/Parallel.h"
 
 #include "ioda/Copying.h"
 #include "ioda/Engines/EngineUtils.h"
@@ -39,6 +42,11 @@ constexpr int nonPoolColor = 2;
 const char poolCommName[] = "IoPool";
 const char nonPoolCommName[] = "NonIoPool";
 
+// Number of io pools created so far by this process. Used to give the split communicator
+// groups of each io pool unique names. All ranks create their io pools in the same order,
+// so the names match across the ranks.
+int ioPoolCount = 0;
+
 //--------------------------------------------------------------------------------------
 void IoPool::setTargetPoolSize() {
     if (rank_all_ == 0) {
@@ -104,9 +112,73 @@ void IoPool::groupRanks(IoPoolGroupMap & rankGrouping) {
     }
 }
 
+//--------------------------------------------------------------------------------------
+void IoPool::groupRanksByNode(IoPoolGroupMap & rankGrouping) {
+    rankGrouping.clear();
+
+    // Find the lowest rank on the node holding this rank. This rank is used to identify
+    // the node. MPI_Comm_split_type isn't available through the eckit interface, so use
+    // the MPI communicator directly. A serial (or otherwise non-MPI) communicator holds
+    // a single rank, which is then treated as running on a single node.
+    int nodeLeader = 0;
+    const eckit::mpi::Parallel * parallelCommAll =
+        dynamic_cast<const eckit::mpi::Parallel *>(&comm_all_);
+    if (size_all_ > 1 && parallelCommAll != nullptr) {
+        MPI_Comm nodeComm;
+        if (MPI_Comm_split_type(parallelCommAll->MPIComm(), MPI_COMM_TYPE_SHARED, rank_all_,
+                                MPI_INFO_NULL, &nodeComm) != MPI_SUCCESS)
+            throw Exception("MPI_Comm_split_type failed", ioda_Here());
+        nodeLeader = rank_all_;
+        const int rc = MPI_Bcast(&nodeLeader, 1, MPI_INT, 0, nodeComm);
+        MPI_Comm_free(&nodeComm);
+        if (rc != MPI_SUCCESS)
+            throw Exception("MPI_Bcast of the node leader rank failed", ioda_Here());
+    } else if (size_all_ > 1) {
+        oops::Log::info() << "IoPool: the communicator does not support node topology "
+                          << "queries, treating all ranks as running on a single node"
+                          << std::endl;
+    }
+
+    std::vector<int> nodeLeaders(size_all_);
+    comm_all_.allGather(nodeLeader, nodeLeaders.begin(), nodeLeaders.end());
+
+    // Number the nodes in the order of their lowest ranks and gather consecutive nodes
+    // into groups. If the max pool size is set explicitly, use enough nodes per group
+    // to stay within that size.
+    std::vector<int> leaders(nodeLeaders);
+    std::sort(leaders.begin(), leaders.end());
+    leaders.erase(std::unique(leaders.begin(), leaders.end()), leaders.end());
+    const int numNodes = leaders.size();
+    int nodesPerGroup = std::max(params_.value().nodesPerPoolTask.value(), 1);
+    if (params_.value().maxPoolSize.value() > 0) {
+        const int maxPoolSize = params_.value().maxPoolSize.value();
+        nodesPerGroup = std::max(nodesPerGroup, (numNodes + maxPoolSize - 1) / maxPoolSize);
+    }
+    target_pool_size_ = (numNodes + nodesPerGroup - 1) / nodesPerGroup;
+    oops::Log::debug() << "IoPool: " << numNodes << " nodes, " << nodesPerGroup
+                       << " nodes per pool rank" << std::endl;
+
+    if (rank_all_ == 0) {
+        // Walk through the ranks in numeric order so that the lowest rank of each group
+        // becomes its pool rank, and the other ranks keep their numeric order.
+        std::vector<std::vector<int>> groups(target_pool_size_);
+        for (int rank = 0; rank < size_all_; ++rank) {
+            const int node = std::lower_bound(leaders.begin(), leaders.end(),
+                                              nodeLeaders[rank]) - leaders.begin();
+            groups[node / nodesPerGroup].push_back(rank);
+        }
+        for (auto & group : groups) {
+            rankGrouping.insert(std::make_pair(
+                group.front(), std::vector<int>(group.begin() + 1, group.end())));
+        }
+    }
+}
+
 //--------------------------------------------------------------------------------------
 void IoPool::assignRanksToIoPool(const std::size_t nlocs, const IoPoolGroupMap & rankGrouping) {
-    constexpr int mpiTagBase = 10000;
+    // Rank 0 sends at most one message to each of the other ranks, so a single tag is
+    // enough (and does not run into the tags used for the data transfers).
+    constexpr int rankAssignmentTag = 10000;
 
     // Collect the nlocs from all of the other ranks.
     std::vector<std::size_t> allNlocs(size_all_);
@@ -153,7 +225,7 @@ void IoPool::assignRanksToIoPool(const std::size_t nlocs, const IoPoolGroupMap &
         rank_assignment_ = rankAssignments[0];
         for (std::size_t i = 1; i < rankAssignments.size(); ++i) {
             if (rankAssignSizes[i] > 0) {
-                comm_all_.send(rankAssignments[i].data(), rankAssignSizes[i], i, mpiTagBase + i);
+                comm_all_.send(rankAssignments[i].data(), rankAssignSizes[i], i, rankAssignmentTag);
             }
         }
     } else {
@@ -165,7 +237,7 @@ void IoPool::assignRanksToIoPool(const std::size_t nlocs, const IoPoolGroupMap &
 
         rank_assignment_.resize(myRankAssignSize);
         if (myRankAssignSize > 0) {
-            comm_all_.receive(rank_assignment_.data(), myRankAssignSize, 0, mpiTagBase + rank_all_);
+            comm_all_.receive(rank_assignment_.data(), myRankAssignSize, 0, rankAssignmentTag);
         }
     }
 }
@@ -191,12 +263,12 @@ void IoPool::createIoPool(IoPoolGroupMap & rankGrouping) {
     }
 
     if (myColor == nonPoolColor) {
-        comm_all_.split(myColor, nonPoolCommName);
+        comm_all_.split(myColor, non_pool_comm_name_.c_str());
         comm_pool_ = nullptr;  // mark that this rank does not belong to an io pool
         rank_pool_ = -1;
         size_pool_ = -1;
     } else {
-        comm_pool_ = &(comm_all_.split(myColor, poolCommName));
+        comm_pool_ = &(comm_all_.split(myColor, pool_comm_name_.c_str()));
         rank_pool_ = comm_pool_->rank();
         size_pool_ = comm_pool_->size();
     }
@@ -257,17 +329,25 @@ IoPool::IoPool(const oops::Parameter<IoPoolParameters> & ioPoolParams,
                      comm_all_(commAll), rank_all_(commAll.rank()), size_all_(commAll.size()),
                      comm_time_(commTime), rank_time_(commTime.rank()),
                      size_time_(commTime.size()), win_start_(winStart), win_end_(winEnd),
-                     nlocs_(nlocs), total_nlocs_(0), global_nlocs_(0) {
-    // For now, the target pool size is simply the minumum of the specified (or default) max
-    // pool size and the size of the comm_all_ communicator group.
-    setTargetPoolSize();
+                     nlocs_(nlocs), total_nlocs_(0), global_nlocs_(0), finalized_(false) {
+    ioPoolCount += 1;
+    pool_comm_name_ = poolCommName + std::to_string(ioPoolCount);
+    non_pool_comm_name_ = nonPoolCommName + std::to_string(ioPoolCount);
 
     // This call will return a data structure that shows how to assign the ranks
     // to the io pools, plus which non io pool ranks get associated with the io pool
     // ranks. Only rank 0 needs to have this data since it will be used to form and
     // send the assignments to the other ranks.
     std::map<int, std::vector<int>> rankGrouping;
-    groupRanks(rankGrouping);
+    if (params_.value().topologyAware) {
+        // The target pool size is the number of groups of nodes.
+        groupRanksByNode(rankGrouping);
+    } else {
+        // The target pool size is simply the minumum of the specified (or default) max
+        // pool size and the size of the comm_all_ communicator group.
+        setTargetPoolSize();
+        groupRanks(rankGrouping);
+    }
 
     // This call will fill in the vector data member rank_assignment_, which holds all of
     // the ranks each member of the io pool needs to communicate with to collect the
@@ -307,9 +387,34 @@ IoPool::IoPool(const oops::Parameter<IoPoolParameters> & ioPoolParams,
     }
     oops::Log::debug() << "create_multiple_files_: " << create_multiple_files_
                        << std::endl;
+
+    // Variable length strings are written directly to the output file unless the file
+    // is written in parallel mode and the HDF5 library cannot write variable length data
+    // in that mode. Use target_pool_size_ (which is the same on all ranks) instead of
+    // is_parallel_io_ (which is only set on the io pool ranks) so that the non io pool
+    // ranks also get the right setting.
+    fixed_length_strings_ = ((!params_.value().writeMultipleFiles) && (target_pool_size_ > 1) &&
+                             (!Engines::HH::canWriteVarLenStringsInParallel()));
+    oops::Log::debug() << "fixed_length_strings_: " << fixed_length_strings_ << std::endl;
 }
 
-IoPool::~IoPool() = default;
+IoPool::~IoPool() {
+    // The send buffers must not be released before the sends are complete.
+    if (!pending_sends_.requests.empty()) {
+        comm_all_.waitAll(pending_sends_.requests);
+    }
+
+    // At this point there are two split communicator groups: one for the io pool and the
+    // other for the processes not included in the io pool. These are released here rather
+    // than in finalize() since the eckit communicator registry is not thread safe, and
+    // finalize() can run on a background thread (see ObsSpace::saveAsync).
+    if (eckit::mpi::hasComm(pool_comm_name_.c_str())) {
+        eckit::mpi::deleteComm(pool_comm_name_.c_str());
+    }
+    if (eckit::mpi::hasComm(non_pool_comm_name_.c_str())) {
+        eckit::mpi::deleteComm(non_pool_comm_name_.c_str());
+    }
+}
 
 //--------------------------------------------------------------------------------------
 
@@ -317,21 +422,62 @@ IoPool::~IoPool() = default;
 void IoPool::save(const Group & srcGroup) {
     Group fileGroup;
     if (comm_pool_ != nullptr) {
-        Engines::WriterCreationParameters createParams(*comm_pool_, comm_time_,
-                                          create_multiple_files_, is_parallel_io_);
-        std::unique_ptr<Engines::WriterBase> writerEngine =
-            Engines::WriterFactory::create(writer_params_, createParams);
+        fileGroup = openOutputFile(false);
+    }
 
-        fileGroup = writerEngine->getObsGroup();
+    // Copy the ObsSpace ObsGroup to the output file Group.
+    ioWriteGroup(*this, srcGroup, fileGroup, is_parallel_io_, fixed_length_strings_,
+                 is_asynchronous() ? &pending_sends_ : nullptr);
+}
 
-        // collect the destination from the writer engine instance
-        std::ostringstream ss;
-        ss << *writerEngine;
-        writerDest_ = ss.str();
+//--------------------------------------------------------------------------------------
+void IoPool::update(const Group & srcGroup, const std::vector<std::string> & varNames) {
+    // With fixed length strings, finalize() rewrites the output file with variable length
+    // strings, which HDF5 versions before 1.14.3 cannot write to in parallel. The flag is the
+    // same on all ranks, so they all write the whole file.
+    if (fixed_length_strings_) {
+        save(srcGroup);
+        return;
     }
 
-    // Copy the ObsSpace ObsGroup to the output file Group.
-    ioWriteGroup(*this, srcGroup, fileGroup, is_parallel_io_);
+    Group fileGroup;
+    if (comm_pool_ != nullptr) {
+        fileGroup = openOutputFile(true);
+    }
+
+    // Copy the listed variables from the ObsSpace ObsGroup to the output file Group.
+    ioUpdateGroup(*this, srcGroup, fileGroup, varNames, is_parallel_io_,
+                  is_asynchronous() ? &pending_sends_ : nullptr);
+}
+
+//--------------------------------------------------------------------------------------
+Group IoPool::openOutputFile(const bool updateExistingFile) {
+    // The chunk cache size is given in bytes and the maximum file size in megabytes.
+    std::size_t chunkCacheSize = 0;
+    if (params_.value().chunkCacheSize.value() != boost::none) {
+        chunkCacheSize = *params_.value().chunkCacheSize.value();
+    }
+    std::size_t maxFileSize = 0;
+    if (params_.value().maxFileSize.value() != boost::none) {
+        maxFileSize = *params_.value().maxFileSize.value() * 1024 * 1024;
+        if (is_parallel_io_ && (rank_pool_ == 0)) {
+            oops::Log::warning() << "WARNING: the io pool \"max file size\" setting "
+                << "is ignored when writing a single output file in parallel mode"
+                << std::endl;
+        }
+    }
+    Engines::WriterCreationParameters createParams(*comm_pool_, comm_time_,
+                                      create_multiple_files_, is_parallel_io_,
+                                      chunkCacheSize, maxFileSize, updateExistingFile);
+    std::unique_ptr<Engines::WriterBase> writerEngine =
+        Engines::WriterFactory::create(writer_params_, createParams);
+
+    // collect the destination from the writer engine instance
+    std::ostringstream ss;
+    ss << *writerEngine;
+    writerDest_ = ss.str();
+
+    return writerEngine->getObsGroup();
 }
 
 void IoPool::workaroundGenFileNames(std::string & finalFileName, std::string & tempFileName) {
@@ -431,37 +577,34 @@ void IoPool::workaroundFixToVarLenStrings(const std::string & finalFileName,
 
 //--------------------------------------------------------------------------------------
 void IoPool::finalize() {
-    // TODO(srh) Workaround until we get fixed length string support in the netcdf-c
-    // library. This is expected to be available in the 4.9.1 release of netcdf-c.
-    // For now move the file with fixed length strings to a temporary
-    // file (obsdataout.obsfile spec with "_flenstr" appended to the filename) and
-    // then copy that file to the intended output file while changing the fixed
-    // length strings to variable length strings.
-    if (comm_pool_ != nullptr) {
-        // Create the temp file name, move the output file to the temp file name,
-        // then copy the file to the intended file name.
-        std::string tempFileName;
-        std::string finalFileName;
-        workaroundGenFileNames(finalFileName, tempFileName);
-
-        // If the output file was created using parallel io, then we only need rank 0
-        // to do the rename, copy workaround.
-        if (is_parallel_io_) {
-            if (comm_pool_->rank() == 0) {
-                workaroundFixToVarLenStrings(finalFileName, tempFileName);
-            }
-        } else {
-            workaroundFixToVarLenStrings(finalFileName, tempFileName);
+    if (finalized_) return;
+    finalized_ = true;
+
+    // In asynchronous mode, complete the transfers from the ranks outside the io pool,
+    // and make sure that all of the io pool ranks are done with the output file.
+    if (is_asynchronous()) {
+        if (!pending_sends_.requests.empty()) {
+            comm_all_.waitAll(pending_sends_.requests);
+        }
+        pending_sends_ = PendingSends();
+        if (comm_pool_ != nullptr) {
+            comm_pool_->barrier();
         }
     }
 
-    // At this point there are two split communicator groups: one for the io pool and the
-    // other for the processes not included in the io pool.
-    if (eckit::mpi::hasComm(poolCommName)) {
-        eckit::mpi::deleteComm(poolCommName);
-    }
-    if (eckit::mpi::hasComm(nonPoolCommName)) {
-        eckit::mpi::deleteComm(nonPoolCommName);
+    // TODO(srh) Workaround for HDF5 libraries that cannot write variable length strings
+    // in parallel io mode (support was added in HDF5 1.14.3). In that case the file was
+    // written with fixed length strings, which the netcdf-c library does not yet handle.
+    // Move the file with fixed length strings to a temporary file (obsdataout.obsfile spec
+    // with "_flenstr" appended to the filename) and then copy that file to the intended
+    // output file while changing the fixed length strings to variable length strings.
+    // Fixed length strings are only used with parallel io, so only rank 0 needs to do
+    // the rename, copy workaround.
+    if ((comm_pool_ != nullptr) && fixed_length_strings_ && (comm_pool_->rank() == 0)) {
+        std::string tempFileName;
+        std::string finalFileName;
+        workaroundGenFileNames(finalFileName, tempFileName);
+        workaroundFixToVarLenStrings(finalFileName, tempFileName);
     }
 }
 
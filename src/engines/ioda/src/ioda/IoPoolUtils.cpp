@@ -6,8 +6,10 @@
  */
 
 #include <iomanip>
+#include <mpi.h>
 #include <sstream>
 
+#include "ioda/Engines/HH.h"
 #include "ioda/Io/IoPoolUtils.h"
 
 namespace ioda {
@@ -34,4 +36,27 @@ std::string uniquifyFileName(const std::string & fileName, std::size_t rankNum,
     return uniqueFileName.insert(found, ss.str());
 }
 
+// -----------------------------------------------------------------------------
+std::string familyFileName(const std::string & fileName) {
+    // Escape percent signs so that only the member number conversion is left.
+    std::string familyName;
+    for (char c : fileName) {
+        familyName += c;
+        if (c == '%') familyName += c;
+    }
+
+    // Insert the member number in front of the file extension.
+    std::size_t found = familyName.find_last_of(".");
+    if (found == std::string::npos)
+      found = familyName.length();
+    return familyName.insert(found, "_part%04d");
+}
+
+// -----------------------------------------------------------------------------
+bool canSaveInBackground() {
+    int threadLevel = MPI_THREAD_SINGLE;
+    MPI_Query_thread(&threadLevel);
+    return (threadLevel == MPI_THREAD_MULTIPLE) && Engines::HH::isLibraryThreadSafe();
+}
+
 }  // namespace ioda
@@ -98,6 +98,21 @@ void ObsGroup::resize(const std::vector<std::pair<Variable, ioda::Dimensions_t>>
   }
 }
 
+MemoryReport ObsGroup::getMemoryReport() const {
+  try {
+    MemoryReport report;
+    const std::vector<std::string> varNames =
+      listObjects(ObjectType::Variable, true)[ObjectType::Variable];
+    for (const std::string& varName : varNames)
+      report[varName] = vars.open(varName).getMemoryUsage();
+    return report;
+  } catch (...) {
+    std::throw_with_nested(Exception(
+      "An exception occurred inside ioda while computing the memory used by an ObsGroup.",
+      ioda_Here()));
+  }
+}
+
 void ObsGroup::resizeVars(Group& g,
                           const std::vector<std::pair<Variable, ioda::Dimensions_t>>& newDims)
 {
@@ -128,7 +143,9 @@ void ObsGroup::resizeVars(Group& g,
             }
           }
         }
-        var.resize(varNewDims);
+        // Variables without a resized dimension are left alone, so that their storage
+        // is not reallocated.
+        if (varNewDims != varDims) var.resize(varNewDims);
       }
     }
   } catch (...) {
@@ -227,6 +227,19 @@ std::tuple<bool, unsigned, unsigned> Variable_Base<>::getSZIPCompression() const
   }
 }
 
+template <>
+MemoryUsage Variable_Base<>::getMemoryUsage() const {
+  try {
+    if (backend_ == nullptr)
+      throw Exception("Missing backend or unimplemented backend function.", ioda_Here());
+    return backend_->getMemoryUsage();
+  } catch (...) {
+    std::throw_with_nested(Exception(
+      "An exception occurred inside ioda while determining a variable's memory usage.",
+      ioda_Here()));
+  }
+}
+
 template <>
 Dimensions Variable_Base<>::getDimensions() const {
   try {
@@ -442,6 +455,8 @@ template class Variable_Base<Variable>;  // NOLINT: Bad check result
 Variable_Backend::~Variable_Backend() = default;
 Variable_Backend::Variable_Backend() : Variable_Base(nullptr) {}
 
+MemoryUsage Variable_Backend::getMemoryUsage() const { return MemoryUsage(); }
+
 std::vector<std::vector<Named_Variable>> Variable_Backend::getDimensionScaleMappings(
   const std::list<Named_Variable>& scalesToQueryAgainst, bool firstOnly) const {
   try {
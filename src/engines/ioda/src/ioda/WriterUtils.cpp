@@ -9,8 +9,14 @@
 
 #include "ioda/Io/WriterUtils.h"
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <numeric>
+#include <string>
+#include <type_traits>
 #include <unordered_set>
 
 #include "eckit/mpi/Comm.h"
@@ -27,8 +33,9 @@
 
 namespace ioda {
 
-constexpr int mpiTagBase = 20000;
-constexpr int varNumTagFactor = 100;
+// Tag of the messages carrying variable data from the ranks outside the io pool to the
+// ranks in the io pool.
+constexpr int ioPoolGatherTag = 20000;
 
 // private functions
 Selection createBlockSelection(const std::vector<Dimensions_t> & varShape,
@@ -112,120 +119,331 @@ void calcVarStartsCounts(const IoPool & ioPool, const Variable & srcVar,
     }
 }
 
+// The data sent by a non io pool rank to its io pool rank are split into sections, one
+// for each variable using the nlocs dimension, in the order of the variable list (which is
+// the same on all ranks). Numeric values are stored as is. Strings are stored as an array
+// of lengths followed by the characters of all strings (without padding or null
+// terminators).
+//
+// The sending rank first sends a manifest holding the size (in bytes) of each section.
+// Then consecutive sections are grouped into blocks of at most maxBufferSize bytes (a
+// section larger than that goes into a block of its own), and each block is sent as one
+// message. Both sides derive the blocks from the manifest, so the receiving rank knows the
+// size of every message in advance and can post its receives ahead of time. This lets the
+// io pool rank receive the next block while it writes the variables of the current block
+// into the file. At most two blocks per assigned rank are held in memory at any time.
+typedef std::size_t ManifestEntry;
+
 template <typename VarType>
-void transferVarDataMPI(const IoPool & ioPool, const Variable & srcVar,
-                        const std::string & varName, int varNumber,
-                        const std::vector<std::size_t> & varStarts,
-                        const std::vector<std::size_t> & varCounts,
-                        Dimensions_t dimFactor, Group & dest,
-                        const bool isParallelIo, const std::size_t strLen) {
+void appendSection(const std::vector<VarType> & values, std::vector<char> & section) {
+    const char * first = reinterpret_cast<const char *>(values.data());
+    section.insert(section.end(), first, first + values.size() * sizeof(VarType));
+}
 
-    std::vector<VarType> varData;
-    srcVar.read<VarType>(varData);
-    if (ioPool.rank_pool() >= 0) {
-        // Resize varData according to total nlocs.
-        Dimensions_t numElements = ioPool.total_nlocs() * dimFactor;
-        varData.resize(numElements);
-
-        // Walk through the rank assignments and issue receive commands.
-        std::vector<eckit::mpi::Request> recvRequests(ioPool.rank_assignment().size());
-        for (std::size_t i = 0; i < ioPool.rank_assignment().size(); ++i) {
-            int fromRank = ioPool.rank_assignment()[i].first;
-            int tag = mpiTagBase + (varNumber * varNumTagFactor) + fromRank;
-            recvRequests[i] = ioPool.comm_all().iReceive(
-                varData.data() + varStarts[i], varCounts[i], fromRank, tag);
-        }
-        ioPool.comm_all().waitAll(recvRequests);
-        Variable destVar = dest.vars.open(varName);
-        if (isParallelIo) {
-            Selection memSelect = createBlockSelection(destVar.getDimensions().dimsCur,
-                                  0, ioPool.total_nlocs(), false);
-            Selection fileSelect = createBlockSelection(destVar.getDimensions().dimsCur,
-                                   ioPool.nlocs_start(), ioPool.total_nlocs(), true);
-            destVar.parallelWrite<VarType>(varData, memSelect, fileSelect);
-        } else {
-            destVar.write<VarType>(varData);
+template <>
+void appendSection<std::string>(const std::vector<std::string> & values,
+                                std::vector<char> & section) {
+    std::vector<ManifestEntry> lengths(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        lengths[i] = values[i].size();
+    }
+    appendSection(lengths, section);
+    for (const std::string & value : values) {
+        section.insert(section.end(), value.begin(), value.end());
+    }
+}
+
+template <typename VarType>
+void extractSection(const char * section, const std::size_t sectionSize,
+                    const std::size_t numValues, VarType * values) {
+    if (sectionSize != numValues * sizeof(VarType)) {
+        throw Exception("Unexpected section size in packed io pool message", ioda_Here());
+    }
+    std::memcpy(values, section, sectionSize);
+}
+
+template <>
+void extractSection<std::string>(const char * section, const std::size_t sectionSize,
+                                 const std::size_t numValues, std::string * values) {
+    if (sectionSize < numValues * sizeof(ManifestEntry)) {
+        throw Exception("Unexpected section size in packed io pool message", ioda_Here());
+    }
+    std::vector<ManifestEntry> lengths(numValues);
+    std::memcpy(lengths.data(), section, numValues * sizeof(ManifestEntry));
+    std::size_t offset = numValues * sizeof(ManifestEntry);
+    for (std::size_t i = 0; i < numValues; ++i) {
+        if (offset + lengths[i] > sectionSize) {
+            throw Exception("End of string not found during MPI transfer", ioda_Here());
         }
-    } else {
-        // Non io pool ranks. These ranks will always read their data from src, and send it as
-        // is to their assigned io pool rank.
-        std::vector<eckit::mpi::Request> sendRequests(ioPool.rank_assignment().size());
-        for (std::size_t i = 0; i < ioPool.rank_assignment().size(); ++i) {
-            int toRank = ioPool.rank_assignment()[i].first;
-            int tag = mpiTagBase + (varNumber * varNumTagFactor) + ioPool.rank_all();
-            sendRequests[i] = ioPool.comm_all().iSend(
-                varData.data() + varStarts[i], varCounts[i], toRank, tag);
+        values[i].assign(section + offset, lengths[i]);
+        offset += lengths[i];
+    }
+}
+
+/// \brief Return the number of bytes in the section holding the values of a variable.
+/// \details The size of a string section depends on the lengths of the strings, so the
+/// values of string variables are read and packed here; the packed section is stored in
+/// \p packedSection to be reused by packBlock(). For other types \p packedSection is left
+/// empty.
+std::size_t calcSectionSize(const Variable & srcVar, const std::string & varName,
+                            std::vector<char> & packedSection) {
+    std::size_t sectionSize = 0;
+    packedSection.clear();
+    VarUtils::forAnySupportedVariableType(
+        srcVar,
+        [&](auto typeDiscriminator) {
+            typedef decltype(typeDiscriminator) T;
+            if (std::is_same<T, std::string>::value) {
+                std::vector<std::string> varData;
+                srcVar.read<std::string>(varData);
+                appendSection(varData, packedSection);
+                sectionSize = packedSection.size();
+            } else {
+                sectionSize = srcVar.getDimensions().numElements * sizeof(T);
+            }
+        },
+        VarUtils::ThrowIfVariableIsOfUnsupportedType(varName));
+    return sectionSize;
+}
+
+/// \brief Throw an exception if a message of \p numBytes bytes is too large to be sent in a
+/// single MPI call (whose count argument is an int).
+void checkMessageSize(const std::size_t numBytes, const std::string & what) {
+    if (numBytes > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        throw Exception("Message too large to be sent to the io pool in one MPI call",
+                        ioda_Here())
+            .add("message", what)
+            .add("bytes", numBytes)
+            .add("limit", std::numeric_limits<int>::max());
+    }
+}
+
+/// \brief Group consecutive sections into blocks of at most maxBufferSize bytes.
+/// \param sectionSizes sizes in bytes of the sections
+/// \param maxBufferSize maximum size of a block (unless it holds a single section)
+/// \param blockStarts on output, index of the first section of each block, followed by
+///        the total number of sections
+/// \details Throws an exception if a section is too large to be sent in one MPI call.
+void groupSectionsIntoBlocks(const std::vector<ManifestEntry> & sectionSizes,
+                             const std::size_t maxBufferSize,
+                             std::vector<std::size_t> & blockStarts) {
+    blockStarts.clear();
+    std::size_t blockSize = 0;
+    for (std::size_t i = 0; i < sectionSizes.size(); ++i) {
+        checkMessageSize(sectionSizes[i], "section " + std::to_string(i));
+        if (blockStarts.empty() || blockSize + sectionSizes[i] > maxBufferSize) {
+            blockStarts.push_back(i);
+            blockSize = 0;
         }
-        ioPool.comm_all().waitAll(sendRequests);
+        blockSize += sectionSizes[i];
     }
+    blockStarts.push_back(sectionSizes.size());
 }
 
-// template specialization for std::string
-template <>
-void transferVarDataMPI<std::string>(const IoPool & ioPool, const Variable & srcVar,
-                        const std::string & varName, const int varNumber,
-                        const std::vector<std::size_t> & varStarts,
-                        const std::vector<std::size_t> & varCounts,
-                        const Dimensions_t dimFactor, Group & dest,
-                        const bool isParallelIo, const std::size_t strLen) {
-    int maxStringLength = strLen + 1;
-
-    std::vector<std::string> varData;
-    srcVar.read<std::string>(varData);
-    if (ioPool.rank_pool() >= 0) {
-        // Resize varData according to total nlocs.
-        Dimensions_t numElements = ioPool.total_nlocs() * dimFactor;
-        varData.resize(numElements);
-
-        // Walk through the rank assignments and issue receive commands.
-        for (std::size_t i = 0; i < ioPool.rank_assignment().size(); ++i) {
-            int fromRank = ioPool.rank_assignment()[i].first;
-            int tag = mpiTagBase + (varNumber * varNumTagFactor) + fromRank;
-            std::vector<char> strBuffer(varCounts[i] * maxStringLength, '\0');
-            ioPool.comm_all().receive(strBuffer.data(), strBuffer.size(), fromRank, tag);
-            for (std::size_t j = 0; j < varCounts[i]; ++j) {
-                std::size_t offset = j * maxStringLength;
-                auto strEnd = std::find(strBuffer.begin() + offset, strBuffer.end(), '\0');
-                if (strEnd == strBuffer.end()) {
-                    throw Exception("End of string not found during MPI transfer", ioda_Here());
+/// \brief Pack the values of a range of variables using the nlocs dimension into a block.
+/// \param packedSections sections already packed by calcSectionSize(); they are moved into
+///        the block and released
+void packBlock(const VarUtils::Vec_Named_Variable & nlocsNamedVars,
+               const std::size_t firstSection, const std::size_t endSection,
+               std::vector<std::vector<char>> & packedSections,
+               std::vector<char> & block) {
+    block.clear();
+    for (std::size_t i = firstSection; i < endSection; ++i) {
+        const Variable & srcVar = nlocsNamedVars[i].var;
+        VarUtils::forAnySupportedVariableType(
+            srcVar,
+            [&](auto typeDiscriminator) {
+                typedef decltype(typeDiscriminator) T;
+                if (std::is_same<T, std::string>::value) {
+                    block.insert(block.end(), packedSections[i].begin(),
+                                 packedSections[i].end());
+                    std::vector<char>().swap(packedSections[i]);
+                } else {
+                    std::vector<T> varData;
+                    srcVar.read<T>(varData);
+                    appendSection(varData, block);
                 }
-                std::string str(strBuffer.begin() + offset, strEnd);
-                varData[varStarts[i] + j] = str;
+            },
+            VarUtils::ThrowIfVariableIsOfUnsupportedType(nlocsNamedVars[i].name));
+    }
+}
+
+/// \brief Send the variables using the nlocs dimension to the assigned io pool rank.
+/// \param ioPool ioda IoPool object
+/// \param nlocsNamedVars variables using the nlocs dimension
+/// \param pendingSends if not null, pack all of the blocks at once and return without
+///        waiting for the sends to complete (the buffers and requests are stored here)
+void sendVarData(const IoPool & ioPool, const VarUtils::Vec_Named_Variable & nlocsNamedVars,
+                 PendingSends * pendingSends) {
+    std::vector<ManifestEntry> manifest(nlocsNamedVars.size());
+    std::vector<std::vector<char>> packedSections(nlocsNamedVars.size());
+    for (std::size_t i = 0; i < nlocsNamedVars.size(); ++i) {
+        manifest[i] = calcSectionSize(nlocsNamedVars[i].var, nlocsNamedVars[i].name,
+                                      packedSections[i]);
+    }
+    std::vector<std::size_t> blockStarts;
+    groupSectionsIntoBlocks(manifest, ioPool.max_buffer_size(), blockStarts);
+    checkMessageSize(manifest.size() * sizeof(ManifestEntry), "manifest");
+
+    if (pendingSends != nullptr) {
+        // The buffers are kept (and the sends completed) by the caller, so the data can
+        // be modified as soon as this function returns.
+        pendingSends->manifests.push_back(std::move(manifest));
+        const std::vector<ManifestEntry> & pendingManifest = pendingSends->manifests.back();
+        for (auto & rankAssignment : ioPool.rank_assignment()) {
+            pendingSends->requests.push_back(ioPool.comm_all().iSend(
+                pendingManifest.data(), pendingManifest.size(), rankAssignment.first,
+                ioPoolGatherTag));
+        }
+        for (std::size_t iblock = 0; iblock + 1 < blockStarts.size(); ++iblock) {
+            pendingSends->buffers.emplace_back();
+            std::vector<char> & block = pendingSends->buffers.back();
+            packBlock(nlocsNamedVars, blockStarts[iblock], blockStarts[iblock + 1],
+                      packedSections, block);
+            checkMessageSize(block.size(), "block of variable data");
+            for (auto & rankAssignment : ioPool.rank_assignment()) {
+                pendingSends->requests.push_back(ioPool.comm_all().iSend(
+                    block.data(), block.size(), rankAssignment.first, ioPoolGatherTag));
             }
         }
-        Variable destVar = dest.vars.open(varName);
-        if (isParallelIo) {
-            Selection memSelect = createBlockSelection(destVar.getDimensions().dimsCur,
-                                  0, ioPool.total_nlocs(), false);
-            Selection fileSelect = createBlockSelection(destVar.getDimensions().dimsCur,
-                                   ioPool.nlocs_start(), ioPool.total_nlocs(), true);
-            destVar.parallelWrite<std::string>(varData, memSelect, fileSelect);
-        } else {
-            destVar.write<std::string>(varData);
+        return;
+    }
+
+    std::vector<eckit::mpi::Request> manifestRequests;
+    for (auto & rankAssignment : ioPool.rank_assignment()) {
+        manifestRequests.push_back(ioPool.comm_all().iSend(
+            manifest.data(), manifest.size(), rankAssignment.first, ioPoolGatherTag));
+    }
+
+    // Keep at most two blocks in flight: the next block is packed while the previous
+    // one is being sent.
+    std::vector<char> blocks[2];
+    std::vector<eckit::mpi::Request> blockRequests[2];
+    for (std::size_t iblock = 0; iblock + 1 < blockStarts.size(); ++iblock) {
+        std::vector<char> & block = blocks[iblock % 2];
+        std::vector<eckit::mpi::Request> & requests = blockRequests[iblock % 2];
+        if (!requests.empty()) {
+            ioPool.comm_all().waitAll(requests);
+            requests.clear();
         }
-    } else {
-        // Non io pool ranks. These ranks will always read their data from src, and send it as
-        // is to their assigned io pool rank.
-        for (std::size_t i = 0; i < ioPool.rank_assignment().size(); ++i) {
-            int toRank = ioPool.rank_assignment()[i].first;
-            int tag = mpiTagBase + (varNumber * varNumTagFactor) + ioPool.rank_all();
-            std::vector<char> strBuffer(varCounts[i] * maxStringLength, '\0');
-            for (std::size_t i = 0; i < varData.size(); ++i) {
-                for (std::size_t j = 0; j < varData[i].size(); ++j) {
-                    std::size_t bufIndx = (i * maxStringLength) + j;
-                    strBuffer[(i * maxStringLength) + j] = varData[i][j];
-                }
-            }
-            ioPool.comm_all().send(strBuffer.data(), strBuffer.size(), toRank, tag);
+        packBlock(nlocsNamedVars, blockStarts[iblock], blockStarts[iblock + 1],
+                  packedSections, block);
+        checkMessageSize(block.size(), "block of variable data");
+        for (auto & rankAssignment : ioPool.rank_assignment()) {
+            requests.push_back(ioPool.comm_all().iSend(
+                block.data(), block.size(), rankAssignment.first, ioPoolGatherTag));
+        }
+    }
+    ioPool.comm_all().waitAll(manifestRequests);
+    for (auto & requests : blockRequests) {
+        if (!requests.empty()) {
+            ioPool.comm_all().waitAll(requests);
         }
     }
 }
 
+/// \brief Blocks of variable data being received from one of the assigned ranks.
+class BlockReceiver {
+ public:
+    /// \param ioPool ioda IoPool object
+    /// \param fromRank rank in the comm_all group sending the data
+    /// \param manifest sizes in bytes of the sections sent by fromRank
+    BlockReceiver(const IoPool & ioPool, const int fromRank,
+                  const std::vector<ManifestEntry> & manifest)
+            : ioPool_(ioPool), fromRank_(fromRank), manifest_(manifest), currentBlock_(0) {
+        groupSectionsIntoBlocks(manifest_, ioPool_.max_buffer_size(), blockStarts_);
+        sectionBlocks_.resize(manifest_.size());
+        sectionOffsets_.resize(manifest_.size());
+        for (std::size_t iblock = 0; iblock + 1 < blockStarts_.size(); ++iblock) {
+            std::size_t offset = 0;
+            for (std::size_t i = blockStarts_[iblock]; i < blockStarts_[iblock + 1]; ++i) {
+                sectionBlocks_[i] = iblock;
+                sectionOffsets_[i] = offset;
+                offset += manifest_[i];
+            }
+        }
+        // Post the receives for the first two blocks.
+        postReceive(0);
+        postReceive(1);
+    }
+
+    /// \brief Return the start of a section, waiting for its block to arrive if needed.
+    /// \details Sections have to be requested in increasing order. Moving on to a new block
+    /// releases the buffer of the previous block and posts the receive for the next one.
+    const char * section(const std::size_t isection) {
+        const std::size_t iblock = sectionBlocks_[isection];
+        if (iblock != currentBlock_ || !received_[iblock % 2]) {
+            ioPool_.comm_all().wait(requests_[iblock % 2]);
+            received_[iblock % 2] = true;
+            if (iblock > currentBlock_) {
+                currentBlock_ = iblock;
+                postReceive(iblock + 1);
+            }
+        }
+        return buffers_[iblock % 2].data() + sectionOffsets_[isection];
+    }
+
+    /// \brief Return the size in bytes of a section.
+    std::size_t sectionSize(const std::size_t isection) const { return manifest_[isection]; }
+
+ private:
+    void postReceive(const std::size_t iblock) {
+        if (iblock + 1 >= blockStarts_.size()) return;
+        std::vector<char> & buffer = buffers_[iblock % 2];
+        buffer.resize(std::accumulate(manifest_.begin() + blockStarts_[iblock],
+                                      manifest_.begin() + blockStarts_[iblock + 1],
+                                      static_cast<std::size_t>(0)));
+        requests_[iblock % 2] = ioPool_.comm_all().iReceive(
+            buffer.data(), buffer.size(), fromRank_, ioPoolGatherTag);
+        received_[iblock % 2] = false;
+    }
+
+    const IoPool & ioPool_;
+    const int fromRank_;
+    const std::vector<ManifestEntry> manifest_;
+    std::vector<std::size_t> blockStarts_;
+    std::vector<std::size_t> sectionBlocks_;
+    std::vector<std::size_t> sectionOffsets_;
+    std::size_t currentBlock_;
+    std::vector<char> buffers_[2];
+    eckit::mpi::Request requests_[2];
+    bool received_[2] = {false, false};
+};
+
+/// \brief Merge the values of a variable on this rank with those received from the
+/// assigned ranks and write them to the output file.
 template <typename VarType>
-void createVariable(const std::string & varName, const Variable & srcVar,
-                    const int adjustNlocs, Has_Variables & destVars,
-                    const std::size_t strLen) {
-    VariableCreationParameters params = srcVar.getCreationParameters(false, false);
+void writeGatheredVarData(const IoPool & ioPool, const Variable & srcVar,
+                          const std::string & varName,
+                          const std::vector<std::size_t> & varStarts,
+                          const std::vector<std::size_t> & varCounts,
+                          const Dimensions_t dimFactor,
+                          const std::vector<const char *> & sectionStarts,
+                          const std::vector<std::size_t> & sectionSizes,
+                          Group & dest, const bool isParallelIo) {
+    std::vector<VarType> varData;
+    srcVar.read<VarType>(varData);
+    // Resize varData according to total nlocs.
+    Dimensions_t numElements = ioPool.total_nlocs() * dimFactor;
+    varData.resize(numElements);
+    for (std::size_t i = 0; i < sectionStarts.size(); ++i) {
+        extractSection(sectionStarts[i], sectionSizes[i], varCounts[i],
+                       varData.data() + varStarts[i]);
+    }
+
+    Variable destVar = dest.vars.open(varName);
+    if (isParallelIo) {
+        Selection memSelect = createBlockSelection(destVar.getDimensions().dimsCur,
+                              0, ioPool.total_nlocs(), false);
+        Selection fileSelect = createBlockSelection(destVar.getDimensions().dimsCur,
+                               ioPool.nlocs_start(), ioPool.total_nlocs(), true);
+        destVar.parallelWrite<VarType>(varData, memSelect, fileSelect);
+    } else {
+        destVar.write<VarType>(varData);
+    }
+}
+
+Dimensions adjustedDimensions(const Variable & srcVar, const int adjustNlocs) {
     Dimensions varDims = srcVar.getDimensions();
     // If adjust Nlocs is >= 0, this means that this is a variable that needs
     // to be created with the total number of locations from the MPI tasks in the pool.
@@ -235,6 +453,35 @@ void createVariable(const std::string & varName, const Variable & srcVar,
             varDims.dimsMax[0] = adjustNlocs;
         }
     }
+    return varDims;
+}
+
+/// \brief Set the chunk shape of an output variable using the nlocs dimension.
+/// \details The chunks hold chunkSize bytes worth of locations and a single element along
+/// the other dimensions, so that readers selecting a range of locations (eg, a time window)
+/// or a single channel only touch the chunks they need. A chunkSize of zero keeps the
+/// chunking of the source variable.
+void setNlocsChunks(VariableCreationParameters & params, const Dimensions & varDims,
+                    const std::size_t elementSize, const std::size_t chunkSize) {
+    if (chunkSize == 0) return;
+    std::vector<Dimensions_t> chunks(varDims.dimsCur.size(), 1);
+    Dimensions_t nlocsChunk =
+        std::max<Dimensions_t>(1, chunkSize / std::max<std::size_t>(1, elementSize));
+    chunks[0] = std::min(nlocsChunk, std::max<Dimensions_t>(1, varDims.dimsCur[0]));
+    params.chunk = true;
+    params.chunks = chunks;
+}
+
+template <typename VarType>
+void createVariable(const std::string & varName, const Variable & srcVar,
+                    const int adjustNlocs, Has_Variables & destVars,
+                    const bool fixedLengthStrings, const std::size_t strLen,
+                    const std::size_t chunkSize) {
+    VariableCreationParameters params = srcVar.getCreationParameters(false, false);
+    Dimensions varDims = adjustedDimensions(srcVar, adjustNlocs);
+    if (adjustNlocs >= 0) {
+        setNlocsChunks(params, varDims, sizeof(VarType), chunkSize);
+    }
     Variable destVar = destVars.create<VarType>(varName, varDims, params);
     copyAttributes(srcVar.atts, destVar.atts);
 }
@@ -243,7 +490,21 @@ void createVariable(const std::string & varName, const Variable & srcVar,
 template <>
 void createVariable<std::string>(const std::string & varName, const Variable & srcVar,
                                  const int adjustNlocs, Has_Variables & destVars,
-                                 const std::size_t strLen) {
+                                 const bool fixedLengthStrings, const std::size_t strLen,
+                                 const std::size_t chunkSize) {
+    // Variable length strings can be written as is (including the fill value). The file
+    // stores a reference to the string data for each element.
+    if (!fixedLengthStrings) {
+        VariableCreationParameters params = srcVar.getCreationParameters(false, false);
+        Dimensions varDims = adjustedDimensions(srcVar, adjustNlocs);
+        if (adjustNlocs >= 0) {
+            setNlocsChunks(params, varDims, sizeof(char *), chunkSize);
+        }
+        Variable destVar = destVars.create<std::string>(varName, varDims, params);
+        copyAttributes(srcVar.atts, destVar.atts);
+        return;
+    }
+
     // Since the fill value is coming from a variable length string, and we are
     // writing out a fixed length string, the fill value might be a longer length
     // than the string length. For now, record the fill value in an attribute
@@ -254,14 +515,9 @@ void createVariable<std::string>(const std::string & varName, const Variable & s
     auto fv = srcVar.getFillValue();
     std::string origFillValue = detail::getFillValue<std::string>(fv);
     params.unsetFillValue();
-    Dimensions varDims = srcVar.getDimensions();
-    // If adjust Nlocs is >= 0, this means that this is a variable that needs
-    // to be created with the total number of locations from the MPI tasks in the pool.
+    Dimensions varDims = adjustedDimensions(srcVar, adjustNlocs);
     if (adjustNlocs >= 0) {
-        varDims.dimsCur[0] = adjustNlocs;
-        if (varDims.dimsMax[0] != ioda::Unlimited) {
-            varDims.dimsMax[0] = adjustNlocs;
-        }
+        setNlocsChunks(params, varDims, strLen, chunkSize);
     }
     // Set the string length in a specialized type.
     Type fixedStrType =
@@ -287,16 +543,49 @@ void identifyVarsUsingNlocs(const ioda::VarUtils::VarDimMap & varDimMap,
 void copyVarData(const ioda::IoPool & ioPool, const ioda::Group & src, ioda::Group & dest,
                  const VarUtils::Vec_Named_Variable & srcNamedVars,
                  const std::unordered_set<std::string> & varsUsingNlocs,
-                 const bool isParallelIo,
-                 const std::map<std::string, std::size_t> & maxStringLengths){
-  // For ranks in the io pool, collect the variable data and write out to the file. The
-  // ranks not in the io pool will participate only in the MPI send/recv calls.
-  int varNumber = 1;
+                 const bool isParallelIo, PendingSends * pendingSends){
+  // Messages between each pair of ranks are matched in the order they were sent, so a
+  // single tag is enough to avoid collisions.
+  VarUtils::Vec_Named_Variable nlocsNamedVars;
+  for (auto & srcNamedVar : srcNamedVars) {
+    if (varsUsingNlocs.count(srcNamedVar.name) > 0) {
+      nlocsNamedVars.push_back(srcNamedVar);
+    }
+  }
+
+  // The ranks not in the io pool send their variables using the nlocs dimension to their
+  // assigned io pool rank.
+  if (ioPool.rank_pool() < 0) {
+    sendVarData(ioPool, nlocsNamedVars, pendingSends);
+    return;
+  }
+
+  // For ranks in the io pool, receive the manifests from the assigned ranks and start
+  // receiving the blocks of variable data.
+  const std::size_t numAssignments = ioPool.rank_assignment().size();
+  std::vector<std::vector<ManifestEntry>> manifests(numAssignments);
+  std::vector<eckit::mpi::Request> manifestRequests(numAssignments);
+  for (std::size_t i = 0; i < numAssignments; ++i) {
+    manifests[i].resize(nlocsNamedVars.size());
+    manifestRequests[i] = ioPool.comm_all().iReceive(
+        manifests[i].data(), manifests[i].size(), ioPool.rank_assignment()[i].first,
+        ioPoolGatherTag);
+  }
+  ioPool.comm_all().waitAll(manifestRequests);
+  std::vector<std::unique_ptr<BlockReceiver>> receivers;
+  for (std::size_t i = 0; i < numAssignments; ++i) {
+    receivers.emplace_back(new BlockReceiver(ioPool, ioPool.rank_assignment()[i].first,
+                                             manifests[i]));
+  }
+
+  // Collect the variable data and write out to the file.
+  std::size_t sectionNumber = 0;
+  std::vector<const char *> varSectionStarts(numAssignments);
+  std::vector<std::size_t> varSectionSizes(numAssignments);
   for (auto & srcNamedVar : srcNamedVars) {
     std::string varName = srcNamedVar.name;
     Variable srcVar = srcNamedVar.var;
-    bool varTypeSupported = true;
-    // Only the variable using the nlocs dimension will need to use MPI send/recv.
+    // Only the variables using the nlocs dimension are gathered from the assigned ranks.
     // If the variable is not using nlocs, then simply transfer data from src to dest.
     if(varsUsingNlocs.count(varName) > 0) {
         // Using nlocs -> calculate the starts and counts for each of the ranks
@@ -306,18 +595,21 @@ void copyVarData(const ioda::IoPool & ioPool, const ioda::Group & src, ioda::Gro
         Dimensions_t dimFactor;
         calcVarStartsCounts(ioPool, srcVar, varStarts, varCounts, dimFactor);
 
-        std::size_t strLen = 0;
-        if (maxStringLengths.find(varName) != maxStringLengths.end()) {
-            strLen = maxStringLengths.at(varName);
+        // Wait for the blocks holding this variable. The following blocks keep arriving
+        // while this variable is written to the file.
+        for (std::size_t i = 0; i < numAssignments; ++i) {
+            varSectionStarts[i] = receivers[i]->section(sectionNumber);
+            varSectionSizes[i] = receivers[i]->sectionSize(sectionNumber);
         }
+        ++sectionNumber;
 
         VarUtils::forAnySupportedVariableType(
             srcVar,
             [&](auto typeDiscriminator) {
                 typedef decltype(typeDiscriminator) T;
-                transferVarDataMPI<T>(ioPool, srcVar, varName, varNumber,
-                                      varStarts, varCounts, dimFactor, dest,
-                                      isParallelIo, strLen);
+                writeGatheredVarData<T>(ioPool, srcVar, varName, varStarts, varCounts,
+                                        dimFactor, varSectionStarts, varSectionSizes,
+                                        dest, isParallelIo);
             },
             VarUtils::ThrowIfVariableIsOfUnsupportedType(varName));
 
@@ -333,7 +625,6 @@ void copyVarData(const ioda::IoPool & ioPool, const ioda::Group & src, ioda::Gro
             },
             VarUtils::ThrowIfVariableIsOfUnsupportedType(varName));
     }
-    varNumber += 1;
   }
 }
 
@@ -344,41 +635,41 @@ void calcMaxStringLengths(const ioda::IoPool & ioPool,
                           std::map<std::string, std::size_t> & maxStringLengths) {
     // Want to collect from every mpi task (comm_all_ communicator group).
     //
-    // Walk through all variables and figure out the max string length which must
-    // be done over the entire set of obs spaces.
+    // Walk through all variables and figure out the max string length on this task,
+    // then take the maximum over the entire set of obs spaces with a single allReduce
+    // covering all of the string variables.
     maxStringLengths.clear();
+    std::vector<std::string> stringVarNames;
+    std::vector<std::size_t> maxStringLens;
     for (auto & namedVar : allVarsList) {
-        std::string varName = namedVar.name;
         Variable var = namedVar.var;
         if (var.isA<std::string>()) {
-            // Variable is a string type. Read in the values and find the maximum
-            // string length. Then do an allReduce to send the maximum of all ranks
-            // to every rank.
             std::vector<std::string> varData;
             var.read(varData);
             std::size_t maxStringLen = 0;
             for (std::size_t i = 0; i < varData.size(); ++i) {
-                if (varData[i].size() > maxStringLen) {
-                    maxStringLen = varData[i].size();
-                }
+                maxStringLen = std::max(maxStringLen, varData[i].size());
             }
-            std::size_t globalMaxStringLen;
-            ioPool.comm_all()
-                .allReduce(maxStringLen, globalMaxStringLen, eckit::mpi::max());
-            // If all of the strings are empty, then globalMaxStringLen is set to
-            // zero which causes problems with the fixed length string type. In this
-            // case, set the globalMaxStringLen to 1.
-            if (globalMaxStringLen == 0) {
-                globalMaxStringLen = 1;
-            }
-            maxStringLengths
-                .insert(std::pair<std::string, std::size_t>(varName, globalMaxStringLen));
+            stringVarNames.push_back(namedVar.name);
+            maxStringLens.push_back(maxStringLen);
         }
     }
+    if (!maxStringLens.empty()) {
+        ioPool.comm_all().allReduceInPlace(maxStringLens.begin(), maxStringLens.end(),
+                                           eckit::mpi::max());
+    }
+    for (std::size_t i = 0; i < stringVarNames.size(); ++i) {
+        // If all of the strings are empty, then the maximum length is zero which
+        // causes problems with the fixed length string type. In this case, set the
+        // maximum length to 1.
+        maxStringLengths.insert(std::pair<std::string, std::size_t>(
+            stringVarNames[i], std::max<std::size_t>(maxStringLens[i], 1)));
+    }
 }
 
 void ioWriteGroup(const ioda::IoPool & ioPool, const ioda::Group& memGroup,
-                  ioda::Group& fileGroup, const bool isParallelIo) {
+                  ioda::Group& fileGroup, const bool isParallelIo,
+                  const bool fixedLengthStrings, PendingSends * pendingSends) {
   using namespace ioda;
   using namespace std;
 
@@ -404,10 +695,13 @@ void ioWriteGroup(const ioda::IoPool & ioPool, const ioda::Group& memGroup,
   std::unordered_set<std::string> varsUsingNlocs;
   identifyVarsUsingNlocs(dimsAttachedToVars, varsUsingNlocs);
 
-  // We need to adjust any string variables to be output as fixed length strings which
-  // entails knowing the maximum string length.
+  // If string variables are to be output as fixed length strings, we need to know
+  // the maximum string length. The fixedLengthStrings flag is the same on all ranks,
+  // so either all or none of the ranks take part in the reduction.
   std::map<std::string, std::size_t> maxStringLengths;
-  calcMaxStringLengths(ioPool, allVarsList, maxStringLengths);
+  if (fixedLengthStrings) {
+      calcMaxStringLengths(ioPool, allVarsList, maxStringLengths);
+  }
 
   // For the ranks in the io pool, we need to first create a file (either a single file
   // or one file per rank in the io pool) containing the groups, attributes and variables.
@@ -457,7 +751,8 @@ void ioWriteGroup(const ioda::IoPool & ioPool, const ioda::Group& memGroup,
           old_var,
           [&](auto typeDiscriminator) {
               typedef decltype(typeDiscriminator) T;
-              createVariable<T>(var_name, old_var, adjustNlocs, fileGroup.vars, strLen);
+              createVariable<T>(var_name, old_var, adjustNlocs, fileGroup.vars,
+                                fixedLengthStrings, strLen, ioPool.chunk_size());
           },
           VarUtils::ThrowIfVariableIsOfUnsupportedType(var_name));
     }
@@ -488,8 +783,95 @@ void ioWriteGroup(const ioda::IoPool & ioPool, const ioda::Group& memGroup,
 
   // Next for the ranks in the "all" communicator group, we collectively transfer the
   // variable data and write it into the file. 
-  copyVarData(ioPool, memGroup, fileGroup, allVarsList, varsUsingNlocs,
-              isParallelIo, maxStringLengths);
+  copyVarData(ioPool, memGroup, fileGroup, allVarsList, varsUsingNlocs, isParallelIo,
+              pendingSends);
+}
+
+//------------------------------------------------------------------------------------
+void ioUpdateGroup(const ioda::IoPool & ioPool, const ioda::Group& memGroup,
+                   ioda::Group& fileGroup, const std::vector<std::string> & varNames,
+                   const bool isParallelIo, PendingSends * pendingSends) {
+  using namespace ioda;
+  using namespace std;
+
+  VarUtils::Vec_Named_Variable regularVarList;
+  VarUtils::Vec_Named_Variable dimVarList;
+  VarUtils::VarDimMap dimsAttachedToVars;
+  Dimensions_t maxVarSize0;  // unused in this function
+  VarUtils::collectVarDimInfo(memGroup, regularVarList, dimVarList,
+                                dimsAttachedToVars, maxVarSize0);
+
+  std::unordered_set<std::string> varsUsingNlocs;
+  identifyVarsUsingNlocs(dimsAttachedToVars, varsUsingNlocs);
+
+  // Keep the listed variables, in the same order as ioWriteGroup so that all ranks walk
+  // through them in the same order.
+  const std::unordered_set<std::string> varsToWrite(varNames.begin(), varNames.end());
+  VarUtils::Vec_Named_Variable updateVarsList;
+  for (const auto & namedVar : regularVarList) {
+    if (varsToWrite.count(namedVar.name) > 0) updateVarsList.push_back(namedVar);
+  }
+  for (const auto & namedVar : dimVarList) {
+    if (varsToWrite.count(namedVar.name) > 0) updateVarsList.push_back(namedVar);
+  }
+
+  // On the io pool ranks, create the groups and variables that are not in the file yet.
+  // The dimension scales were all written by the earlier save.
+  if (ioPool.rank_pool() >= 0) {
+    const auto memObjects = memGroup.listObjects(ObjectType::Ignored, true);
+    for (const auto &g_name : memObjects.at(ObjectType::Group)) {
+      if (!fileGroup.exists(g_name)) {
+        Group old_g = memGroup.open(g_name);
+        Group new_g = fileGroup.create(g_name);
+        copyAttributes(old_g.atts, new_g.atts);
+      }
+    }
+
+    int poolNlocs;
+    if (isParallelIo) {
+        poolNlocs = ioPool.global_nlocs();
+    } else {
+        poolNlocs = ioPool.total_nlocs();
+    }
+
+    std::unordered_set<std::string> newVarNames;
+    for (const auto& namedVar : updateVarsList) {
+      std::string var_name = namedVar.name;
+      if (fileGroup.vars.exists(var_name)) continue;
+      newVarNames.insert(var_name);
+      int adjustNlocs = -1;
+      if (varsUsingNlocs.count(var_name)) {
+          adjustNlocs = poolNlocs;
+      }
+      const Variable old_var = namedVar.var;
+      VarUtils::forAnySupportedVariableType(
+          old_var,
+          [&](auto typeDiscriminator) {
+              typedef decltype(typeDiscriminator) T;
+              createVariable<T>(var_name, old_var, adjustNlocs, fileGroup.vars,
+                                false, 0, ioPool.chunk_size());
+          },
+          VarUtils::ThrowIfVariableIsOfUnsupportedType(var_name));
+    }
+
+    vector<pair<Variable, vector<Variable>>> dimsAttachedToNewVars;
+    for (const auto &old : dimsAttachedToVars) {
+      if (newVarNames.count(old.first.name) == 0) continue;
+      Variable new_var = fileGroup.vars[old.first.name];
+      vector<Variable> new_dims;
+      for (const auto &old_dim : old.second) {
+          new_dims.push_back(fileGroup.vars[old_dim.name]);
+      }
+      dimsAttachedToNewVars.push_back(make_pair(new_var, std::move(new_dims)));
+    }
+    if (!dimsAttachedToNewVars.empty()) {
+      fileGroup.vars.attachDimensionScales(dimsAttachedToNewVars);
+    }
+  }
+
+  // Transfer the variable data and overwrite it in the file.
+  copyVarData(ioPool, memGroup, fileGroup, updateVarsList, varsUsingNlocs, isParallelIo,
+              pendingSends);
 }
 
 }  // namespace ioda
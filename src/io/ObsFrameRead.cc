@@ -572,31 +572,30 @@ void ObsFrameRead::applyMpiDistribution(const std::shared_ptr<Distribution> & di
     latLonVar.read(lats, memSelect, frameSelect);
     lats.resize(frameCount);
 
-    // Generate the index and recnums for this frame.
-    const std::size_t commSize = params_.comm().size();
-    const std::size_t commRank = params_.comm().rank();
-    std::size_t rowNum = 0;
-    std::size_t recNum = 0;
-    std::size_t frameIndex = 0;
-    std::size_t globalLocIndex = 0;
-    frame_loc_index_.clear();
+    // Assign all locations of this frame to records in one go, so that the distribution
+    // can take the whole frame into account.
+    std::vector<std::size_t> recNums(locSize);
+    std::vector<std::size_t> globalLocIndices(locSize);
+    std::vector<eckit::geometry::Point2> points(locSize);
     for (std::size_t i = 0; i < locSize; ++i) {
-        rowNum = locIndex[i];
-        recNum = records[i];
         // The current frame storage always starts at zero so frameIndex
         // needs to be the offset from the ObsIo frame start.
-        frameIndex = rowNum - frameStart;
-
-        eckit::geometry::Point2 point(lons[frameIndex], lats[frameIndex]);
-
-        std::size_t globalLocIndex = rowNum;
-        dist_->assignRecord(recNum, globalLocIndex, point);
+        const std::size_t frameIndex = locIndex[i] - frameStart;
+        recNums[i] = records[i];
+        globalLocIndices[i] = locIndex[i];
+        points[i] = eckit::geometry::Point2(lons[frameIndex], lats[frameIndex]);
+    }
+    dist_->assignRecords(recNums, globalLocIndices, points);
 
+    // Generate the index and recnums for this frame.
+    frame_loc_index_.clear();
+    for (std::size_t i = 0; i < locSize; ++i) {
+        const std::size_t recNum = recNums[i];
         if (dist->isMyRecord(recNum)) {
-            indx_.push_back(globalLocIndex);
+            indx_.push_back(globalLocIndices[i]);
             recnums_.push_back(recNum);
             unique_rec_nums_.insert(recNum);
-            frame_loc_index_.push_back(frameIndex);
+            frame_loc_index_.push_back(locIndex[i] - frameStart);
             nlocs_++;
         }
     }
@@ -262,13 +262,19 @@ void testDistributionConstructedManually() {
       std::iota(Groups.begin(), Groups.end(), 0);
     }
 
+    // Assign all locations in one batch, as done when reading a single frame.
+    std::vector<std::size_t> Locs(Gnlocs);
+    std::iota(Locs.begin(), Locs.end(), 0);
+    std::vector<eckit::geometry::Point2> Points;
+    for (std::size_t j = 0; j < Gnlocs; ++j)
+      Points.push_back(eckit::geometry::Point2(glons[j], glats[j]));
+    TestDist->assignRecords(Groups, Locs, Points);
+
     // Loop on gnlocs, and keep the indecies according to the distribution type.
     std::vector<std::size_t> Index;
     std::vector<std::size_t> Recnums;
     for (std::size_t j = 0; j < Gnlocs; ++j) {
       std::size_t RecNum = Groups[j];
-      eckit::geometry::Point2 point(glons[j], glats[j]);
-      TestDist->assignRecord(RecNum, j, point);
       if (TestDist->isMyRecord(RecNum)) {
         Index.push_back(j);
         Recnums.push_back(RecNum);
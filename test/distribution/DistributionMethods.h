@@ -26,8 +26,10 @@
 #include "oops/util/Logger.h"
 
 #include "ioda/distribution/Accumulator.h"
+#include "ioda/distribution/AsyncReduction.h"
 #include "ioda/distribution/Distribution.h"
 #include "ioda/distribution/DistributionFactory.h"
+#include "ioda/distribution/ReductionBatch.h"
 
 namespace ioda {
 namespace test {
@@ -164,6 +166,87 @@ void testMinVector(const Distribution &TestDist, const std::vector<size_t> &myRe
   EXPECT_EQUAL(mins, expectedMins);
 }
 
+template <typename T>
+void testReductionBatch(const Distribution &TestDist, const std::vector<size_t> &myRecords,
+                        size_t expectedSum, size_t expectedMin, size_t expectedMax) {
+  const T shift = 10;
+
+  // Perform local reductions
+  auto scalarAccumulator = TestDist.createAccumulator<T>();
+  auto vectorAccumulator = TestDist.createAccumulator<T>(2);
+  T min = bigNumber<T>();
+  T max = std::numeric_limits<T>::lowest();
+  std::vector<T> mins(2, bigNumber<T>());
+  std::vector<T> maxes(2, std::numeric_limits<T>::lowest());
+  for (size_t loc = 0; loc < myRecords.size(); ++loc) {
+    scalarAccumulator->addTerm(loc, myRecords[loc]);
+    vectorAccumulator->addTerm(loc, 0, myRecords[loc]);
+    vectorAccumulator->addTerm(loc, 1, myRecords[loc] + shift);
+    min = std::min<T>(min, myRecords[loc]);
+    max = std::max<T>(max, myRecords[loc]);
+    mins[0] = std::min<T>(mins[0], myRecords[loc]);
+    mins[1] = std::min<T>(mins[1], myRecords[loc] + shift);
+    maxes[0] = std::max<T>(maxes[0], myRecords[loc]);
+    maxes[1] = std::max<T>(maxes[1], myRecords[loc] + shift);
+  }
+
+  // Perform all global reductions at once
+  T sum;
+  std::vector<T> sums;
+  ReductionBatch batch(TestDist);
+  batch.sum(*scalarAccumulator, sum);
+  batch.sum(*vectorAccumulator, sums);
+  batch.min(min);
+  batch.max(max);
+  batch.min(mins);
+  batch.max(maxes);
+  batch.execute();
+
+  EXPECT_EQUAL(sum, static_cast<T>(expectedSum));
+  EXPECT_EQUAL(sums, vectorAccumulator->computeResult());
+  EXPECT_EQUAL(min, static_cast<T>(expectedMin));
+  EXPECT_EQUAL(max, static_cast<T>(expectedMax));
+  const std::vector<T> expectedMins{static_cast<T>(expectedMin),
+                                    static_cast<T>(expectedMin + shift)};
+  const std::vector<T> expectedMaxes{static_cast<T>(expectedMax),
+                                     static_cast<T>(expectedMax + shift)};
+  EXPECT_EQUAL(mins, expectedMins);
+  EXPECT_EQUAL(maxes, expectedMaxes);
+}
+
+template <typename T>
+void testAsyncReduction(const Distribution &TestDist, const std::vector<size_t> &myRecords,
+                        size_t expectedSum, size_t expectedMin, size_t expectedMax) {
+  const T shift = 10;
+
+  // Perform local reductions
+  auto scalarAccumulator = TestDist.createAccumulator<T>();
+  auto vectorAccumulator = TestDist.createAccumulator<T>(2);
+  T min = bigNumber<T>();
+  std::vector<T> maxes(2, std::numeric_limits<T>::lowest());
+  for (size_t loc = 0; loc < myRecords.size(); ++loc) {
+    scalarAccumulator->addTerm(loc, myRecords[loc]);
+    vectorAccumulator->addTerm(loc, 0, myRecords[loc]);
+    vectorAccumulator->addTerm(loc, 1, myRecords[loc] + shift);
+    min = std::min<T>(min, myRecords[loc]);
+    maxes[0] = std::max<T>(maxes[0], myRecords[loc]);
+    maxes[1] = std::max<T>(maxes[1], myRecords[loc] + shift);
+  }
+
+  // Start the global reductions, then collect their results
+  AsyncReduction<T> sum = startSum(TestDist, *scalarAccumulator);
+  AsyncReduction<std::vector<T>> sums = startSum(TestDist, *vectorAccumulator);
+  AsyncReduction<T> globalMin = startMin(TestDist, min);
+  AsyncReduction<std::vector<T>> globalMaxes = startMax(TestDist, maxes);
+
+  EXPECT_EQUAL(globalMin.get(), static_cast<T>(expectedMin));
+  EXPECT_EQUAL(sum.get(), static_cast<T>(expectedSum));
+  const std::vector<T> expectedMaxes{static_cast<T>(expectedMax),
+                                     static_cast<T>(expectedMax + shift)};
+  EXPECT_EQUAL(globalMaxes.get(), expectedMaxes);
+  EXPECT_EQUAL(sums.get(), vectorAccumulator->computeResult());
+}
+
 void testDistributionMethods() {
   eckit::LocalConfiguration conf(::test::TestEnvironment::config());
 
@@ -235,6 +318,16 @@ void testDistributionMethods() {
     testMinVector<float>(*TestDist, myRecords, expectedMin);
     testMinVector<int>(*TestDist, myRecords, expectedMin);
     testMinVector<size_t>(*TestDist, myRecords, expectedMin);
+
+    testReductionBatch<double>(*TestDist, myRecords, expectedSum, expectedMin, expectedMax);
+    testReductionBatch<float>(*TestDist, myRecords, expectedSum, expectedMin, expectedMax);
+    testReductionBatch<int>(*TestDist, myRecords, expectedSum, expectedMin, expectedMax);
+    testReductionBatch<size_t>(*TestDist, myRecords, expectedSum, expectedMin, expectedMax);
+
+    testAsyncReduction<double>(*TestDist, myRecords, expectedSum, expectedMin, expectedMax);
+    testAsyncReduction<float>(*TestDist, myRecords, expectedSum, expectedMin, expectedMax);
+    testAsyncReduction<int>(*TestDist, myRecords, expectedSum, expectedMin, expectedMax);
+    testAsyncReduction<size_t>(*TestDist, myRecords, expectedSum, expectedMin, expectedMax);
   }
 }
 
@@ -8,9 +8,13 @@
 #ifndef TEST_IODA_OBSSPACE_H_
 #define TEST_IODA_OBSSPACE_H_
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
 #include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #define ECKIT_TESTING_SELF_REGISTER_CASES 0
@@ -722,6 +726,263 @@ void testDerivedObsError() {
 
 // -----------------------------------------------------------------------------
 
+// Verify that the time offsets and epoch of MetaData/dateTime are consistent with the DateTime
+// values returned by get_db and that all locations lie inside the DA window.
+void testTimeOffsets() {
+  typedef ObsSpaceTestFixture Test_;
+
+  for (std::size_t jj = 0; jj < Test_::size(); ++jj) {
+    const ioda::ObsSpace & odb = Test_::obspace(jj);
+    if (!odb.has("MetaData", "dateTime"))
+      continue;
+
+    std::vector<util::DateTime> dates(odb.nlocs());
+    odb.get_db("MetaData", "dateTime", dates);
+    std::vector<int64_t> offsets;
+    util::DateTime epoch;
+    odb.get_time_offsets("MetaData", "dateTime", offsets, epoch);
+
+    EXPECT_EQUAL(offsets.size(), dates.size());
+    EXPECT(epoch == odb.epoch("MetaData", "dateTime"));
+    for (std::size_t loc = 0; loc < offsets.size(); ++loc)
+      EXPECT_EQUAL(offsets[loc], (dates[loc] - epoch).toSeconds());
+
+    const std::vector<bool> inside = odb.insideTimeWindow(offsets, epoch);
+    EXPECT(std::all_of(inside.begin(), inside.end(), [](bool b) { return b; }));
+    EXPECT_EQUAL(odb.windowStartOffset(epoch), (odb.windowStart() - epoch).toSeconds());
+    EXPECT_EQUAL(odb.windowEndOffset(epoch), (odb.windowEnd() - epoch).toSeconds());
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+// Verify that get_db, has and dtype can be called concurrently from several threads, and so
+// can put_db on distinct variables.
+void testConcurrentAccess() {
+  typedef ObsSpaceTestFixture Test_;
+  const std::size_t numThreads = 8;
+  const std::size_t numIterations = 20;
+
+  const util::DateTime bgn(::test::TestEnvironment::config().getString("window begin"));
+  const util::DateTime end(::test::TestEnvironment::config().getString("window end"));
+
+  for (std::size_t jj = 0; jj < Test_::size(); ++jj) {
+    // The threads add their own variables, so work on a private copy of the ObsSpace
+    // rather than on the one shared with (and saved by) the other tests.
+    eckit::LocalConfiguration obsconf(Test_::config(jj), "obs space");
+    ioda::ObsTopLevelParameters obsparams;
+    obsparams.validateAndDeserialize(obsconf);
+    ioda::ObsSpace odb(obsparams, oops::mpi::world(), bgn, end, oops::mpi::myself());
+    if (!odb.has("MetaData", "latitude") || !odb.has("MetaData", "dateTime"))
+      continue;
+
+    // Read the reference values serially.
+    std::vector<float> expectedLats(odb.nlocs());
+    odb.get_db("MetaData", "latitude", expectedLats);
+    std::vector<util::DateTime> expectedDates(odb.nlocs());
+    odb.get_db("MetaData", "dateTime", expectedDates);
+    std::vector<std::string> obsvars;
+    for (std::size_t ivar = 0; ivar < odb.obsvariables().size(); ++ivar)
+      if (odb.dtype("ObsValue", odb.obsvariables()[ivar]) == ObsDtype::Float)
+        obsvars.push_back(odb.obsvariables()[ivar]);
+    std::vector<std::vector<float>> expectedObs(obsvars.size(),
+                                                std::vector<float>(odb.nlocs()));
+    for (std::size_t ivar = 0; ivar < obsvars.size(); ++ivar)
+      odb.get_db("ObsValue", obsvars[ivar], expectedObs[ivar]);
+
+    std::vector<int> failures(numThreads, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t ithread = 0; ithread < numThreads; ++ithread) {
+      threads.emplace_back([&, ithread]() {
+        const std::string ownVar = "var" + std::to_string(ithread);
+        std::vector<int> ownValues(odb.nlocs(), static_cast<int>(ithread));
+        for (std::size_t iter = 0; iter < numIterations; ++iter) {
+          std::vector<float> lats(odb.nlocs());
+          odb.get_db("MetaData", "latitude", lats);
+          failures[ithread] += (lats != expectedLats);
+
+          std::vector<util::DateTime> dates(odb.nlocs());
+          odb.get_db("MetaData", "dateTime", dates);
+          failures[ithread] += (dates != expectedDates);
+
+          for (std::size_t ivar = 0; ivar < obsvars.size(); ++ivar) {
+            std::vector<float> obs(odb.nlocs());
+            odb.get_db("ObsValue", obsvars[ivar], obs);
+            failures[ithread] += (obs != expectedObs[ivar]);
+            failures[ithread] += (odb.dtype("ObsValue", obsvars[ivar]) != ObsDtype::Float);
+          }
+
+          // Each thread creates (in the first iteration) and then updates its own variable.
+          ownValues[iter % ownValues.size()] = static_cast<int>(iter);
+          odb.put_db("ConcurrencyTest", ownVar, ownValues);
+          std::vector<int> readBack(odb.nlocs());
+          odb.get_db("ConcurrencyTest", ownVar, readBack);
+          failures[ithread] += (readBack != ownValues);
+          failures[ithread] += !odb.has("ConcurrencyTest", ownVar);
+        }
+      });
+    }
+    for (std::thread & thread : threads)
+      thread.join();
+
+    for (std::size_t ithread = 0; ithread < numThreads; ++ithread)
+      EXPECT_EQUAL(failures[ithread], 0);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+// Verify that rebalancing an ObsSpace preserves the global numbers of locations and records
+// and keeps whole records on a single task.
+void testRebalance() {
+  typedef ObsSpaceTestFixture Test_;
+
+  const util::DateTime bgn(::test::TestEnvironment::config().getString("window begin"));
+  const util::DateTime end(::test::TestEnvironment::config().getString("window end"));
+
+  for (std::size_t jj = 0; jj < Test_::size(); ++jj) {
+    // Rebalancing moves locations between tasks, so work on a private copy of the ObsSpace
+    // rather than on the one shared with the other tests.
+    eckit::LocalConfiguration obsconf(Test_::config(jj), "obs space");
+    ioda::ObsTopLevelParameters obsparams;
+    obsparams.validateAndDeserialize(obsconf);
+    ioda::ObsSpace odb(obsparams, oops::mpi::world(), bgn, end, oops::mpi::myself());
+    if (odb.distribution()->name() != "RoundRobin" || !odb.has("MetaData", "latitude"))
+      continue;
+
+    const eckit::mpi::Comm & comm = odb.comm();
+    const std::size_t globalNlocs = odb.globalNumLocs();
+
+    // Deactivate all locations on even-numbered tasks to unbalance the active locations. The
+    // flags are stored in the ObsSpace so that they move together with the locations.
+    std::vector<bool> activeLocs(odb.nlocs(), comm.rank() % 2 == 1);
+    odb.put_db("TestFlags", "active",
+               std::vector<int>(activeLocs.begin(), activeLocs.end()));
+
+    // Return the difference between the largest and smallest numbers of active locations
+    // held by a task.
+    auto activeLocsSpread = [&odb, &comm]() {
+      std::vector<int> active(odb.nlocs());
+      odb.get_db("TestFlags", "active", active);
+      std::size_t minActive = std::count(active.begin(), active.end(), 1);
+      std::size_t maxActive = minActive;
+      comm.allReduceInPlace(minActive, eckit::mpi::min());
+      comm.allReduceInPlace(maxActive, eckit::mpi::max());
+      return maxActive - minActive;
+    };
+
+    // Return the latitudes of all locations held by all tasks, sorted.
+    auto allLatitudes = [&odb, &comm]() {
+      std::vector<float> latitudes(odb.nlocs());
+      odb.get_db("MetaData", "latitude", latitudes);
+      oops::mpi::allGatherv(comm, latitudes);
+      std::sort(latitudes.begin(), latitudes.end());
+      return latitudes;
+    };
+
+    const std::size_t spreadBefore = activeLocsSpread();
+    const std::vector<float> latitudesBefore = allLatitudes();
+
+    std::shared_ptr<const ioda::Distribution> dist = odb.rebalance(activeLocs);
+    EXPECT(dist == odb.distribution());
+
+    // No location has been lost or duplicated.
+    EXPECT_EQUAL(odb.globalNumLocs(), globalNlocs);
+    EXPECT_EQUAL(allLatitudes(), latitudesBefore);
+    for (std::size_t loc = 0; loc < odb.nlocs(); ++loc)
+      EXPECT(dist->isMyRecord(odb.recnum()[loc]));
+
+    // The active locations are spread more evenly than before.
+    const std::size_t spreadAfter = activeLocsSpread();
+    oops::Log::info() << "testRebalance: spread of active locations per task went from "
+                      << spreadBefore << " to " << spreadAfter << std::endl;
+    if (spreadBefore > 1)
+      EXPECT(spreadAfter < spreadBefore);
+    else
+      EXPECT(spreadAfter <= spreadBefore);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+// Verify that the memory report covers the values of every float variable and that the
+// collective report can be printed.
+void testMemoryReport() {
+  typedef ObsSpaceTestFixture Test_;
+
+  for (std::size_t jj = 0; jj < Test_::size(); ++jj) {
+    const ioda::ObsSpace & odb = Test_::obspace(jj);
+    const ioda::MemoryReport report = odb.getObsGroup().getMemoryReport();
+    EXPECT(!report.empty());
+    for (const auto & entry : report) {
+      if (entry.first.compare(0, 9, "ObsValue/") != 0)
+        continue;
+      const std::string varName = entry.first.substr(9);
+      if (odb.dtype("ObsValue", varName) == ioda::ObsDtype::Float)
+        EXPECT(entry.second.dataBytes + entry.second.mappedBytes >=
+               odb.nlocs() * sizeof(float));
+    }
+
+    std::stringstream os;
+    odb.printMemoryReport(os);
+    if (odb.comm().rank() == 0)
+      EXPECT(os.str().find("ObsValue") != std::string::npos);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+// Exercise the handles returned by ObsSpace::saveAsync(): a default handle and the handle of a
+// save that has completed are done; starting a second save completes the first one; and a
+// save still running when its ObsSpace is destroyed (together with the communicator used by the
+// background thread) is completed by the destructor and can still be waited on.
+void testSaveAsync() {
+  typedef ObsSpaceTestFixture Test_;
+
+  const util::DateTime bgn(::test::TestEnvironment::config().getString("window begin"));
+  const util::DateTime end(::test::TestEnvironment::config().getString("window end"));
+
+  const ioda::SaveHandle defaultHandle;
+  EXPECT(defaultHandle.done());
+  defaultHandle.wait();
+
+  for (std::size_t jj = 0; jj < Test_::size(); ++jj) {
+    eckit::LocalConfiguration obsconf(Test_::config(jj), "obs space");
+    eckit::LocalConfiguration outconf;
+    outconf.set("engine.type", "H5File");
+    outconf.set("engine.obsfile", "testoutput/obsspace_save_async_" + std::to_string(jj) +
+                                  ".nc4");
+    obsconf.set("obsdataout", outconf);
+    ioda::ObsTopLevelParameters obsparams;
+    obsparams.validateAndDeserialize(obsconf);
+
+    ioda::SaveHandle lastHandle;
+    {
+      ioda::ObsSpace odb(obsparams, oops::mpi::world(), bgn, end, oops::mpi::myself());
+
+      ioda::SaveHandle firstHandle = odb.saveAsync();
+      ioda::SaveHandle secondHandle = odb.saveAsync();
+      // The second save can only start once the first one is complete.
+      EXPECT(firstHandle.done());
+      firstHandle.wait();
+      secondHandle.wait();
+      EXPECT(secondHandle.done());
+
+      // Modify the ObsSpace while the last save may still be running; the file holds the
+      // values copied when the save started.
+      lastHandle = odb.saveAsync();
+      std::vector<float> latitudes(odb.nlocs(), 0.0f);
+      if (odb.has("MetaData", "latitude"))
+        odb.put_db("MetaData", "latitude", latitudes);
+    }
+    // The destructor has waited for the last save and released its communicator.
+    EXPECT(lastHandle.done());
+    lastHandle.wait();
+  }
+}
+
+// -----------------------------------------------------------------------------
+
 void testCleanup() {
   // This test removes the obsspaces and ensures that they evict their contents
   // to disk successfully.
@@ -755,6 +1016,16 @@ class ObsSpace : public oops::Test {
       { testWriteableGroup(); });
     ts.emplace_back(CASE("ioda/ObsSpace/testMultiDimTransfer")
       { testMultiDimTransfer(); });
+    ts.emplace_back(CASE("ioda/ObsSpace/testConcurrentAccess")
+      { testConcurrentAccess(); });
+    ts.emplace_back(CASE("ioda/ObsSpace/testTimeOffsets")
+      { testTimeOffsets(); });
+    ts.emplace_back(CASE("ioda/ObsSpace/testRebalance")
+      { testRebalance(); });
+    ts.emplace_back(CASE("ioda/ObsSpace/testMemoryReport")
+      { testMemoryReport(); });
+    ts.emplace_back(CASE("ioda/ObsSpace/testSaveAsync")
+      { testSaveAsync(); });
     ts.emplace_back(CASE("ioda/ObsSpace/testCleanup")
       { testCleanup(); });
   }
@@ -0,0 +1,128 @@
+/*
+ * (C) Copyright 2021 UCAR
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#ifndef TEST_IODA_OBSSPACEOUTPUTSELECTION_H_
+#define TEST_IODA_OBSSPACEOUTPUTSELECTION_H_
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/testing/Test.h"
+
+#include "oops/runs/Test.h"
+#include "oops/test/TestEnvironment.h"
+#include "oops/util/Logger.h"
+
+#include "ioda/Engines/HH.h"
+#include "ioda/Group.h"
+
+namespace ioda {
+namespace test {
+
+// -----------------------------------------------------------------------------
+/// Returns the number of locations spanned by the first dimension of the variable `name`.
+Dimensions_t numLocations(const Group & group, const std::string & name) {
+  return group.vars.open(name).getDimensions().dimsCur[0];
+}
+
+// -----------------------------------------------------------------------------
+/// Returns the values of the variables listed in `names` at each location of `group`,
+/// sorted so that they can be compared regardless of the order of the locations.
+std::vector<std::vector<float>> sortedLocationValues(const Group & group,
+                                                     const std::vector<std::string> & names,
+                                                     const std::vector<bool> & keep) {
+  std::vector<std::vector<float>> rows;
+  for (std::size_t loc = 0; loc < keep.size(); ++loc)
+    if (keep[loc])
+      rows.push_back(std::vector<float>());
+  for (const std::string & name : names) {
+    const std::vector<float> values = group.vars.open(name).readAsVector<float>();
+    EXPECT_EQUAL(values.size(), keep.size());
+    std::size_t row = 0;
+    for (std::size_t loc = 0; loc < keep.size(); ++loc)
+      if (keep[loc])
+        rows[row++].push_back(values[loc]);
+  }
+  std::sort(rows.begin(), rows.end());
+  return rows;
+}
+
+// -----------------------------------------------------------------------------
+/// Checks that an output file written with the obsdataout "include variables",
+/// "exclude variables" and "drop qc flags" options holds exactly the selected subset
+/// of the input file.
+CASE("ioda/ObsSpace/testOutputSelection") {
+  const eckit::LocalConfiguration conf(::test::TestEnvironment::config(), "output selection");
+
+  const Group input = Engines::HH::openFile(conf.getString("input file"),
+                                            Engines::BackendOpenModes::Read_Only);
+  const Group output = Engines::HH::openFile(conf.getString("output file"),
+                                             Engines::BackendOpenModes::Read_Only);
+
+  // Only the selected groups are written, less the excluded variables.
+  const std::vector<std::string> keptGroups = conf.getStringVector("kept groups");
+  for (const std::string & groupName : output.list()) {
+    oops::Log::info() << "Output group: " << groupName << std::endl;
+    EXPECT(std::find(keptGroups.begin(), keptGroups.end(), groupName) != keptGroups.end());
+  }
+  for (const std::string & varName : conf.getStringVector("excluded variables")) {
+    EXPECT(input.vars.exists(varName));
+    EXPECT_NOT(output.vars.exists(varName));
+  }
+
+  // Find the input locations where some of the qc flags are not among the dropped ones.
+  const std::string qcGroupName = conf.getString("qc group");
+  const std::vector<int> droppedFlagsVec = conf.getIntVector("dropped qc flags");
+  const std::set<int> droppedFlags(droppedFlagsVec.begin(), droppedFlagsVec.end());
+  const std::vector<std::string> qcVarNames =
+      input.open(qcGroupName).listObjects<ObjectType::Variable>();
+  EXPECT_NOT(qcVarNames.empty());
+
+  const std::size_t inputNlocs = numLocations(input, "nlocs");
+  std::vector<bool> keep(inputNlocs, false);
+  for (const std::string & qcVarName : qcVarNames) {
+    const std::vector<int> flags =
+        input.vars.open(qcGroupName + "/" + qcVarName).readAsVector<int>();
+    // Variables with a channel dimension hold the flags of each location in a contiguous row.
+    const std::size_t rowLength = flags.size() / inputNlocs;
+    for (std::size_t loc = 0; loc < inputNlocs; ++loc)
+      for (std::size_t i = loc * rowLength; i < (loc + 1) * rowLength; ++i)
+        if (droppedFlags.count(flags[i]) == 0)
+          keep[loc] = true;
+  }
+  const std::size_t numKept = std::count(keep.begin(), keep.end(), true);
+  EXPECT(numKept > 0);
+  EXPECT(numKept < inputNlocs);
+
+  // The output holds exactly the kept locations, possibly in a different order.
+  const std::size_t outputNlocs = numLocations(output, "nlocs");
+  EXPECT_EQUAL(outputNlocs, numKept);
+  const std::vector<std::string> keyVarNames = conf.getStringVector("location key variables");
+  EXPECT(sortedLocationValues(output, keyVarNames, std::vector<bool>(outputNlocs, true)) ==
+         sortedLocationValues(input, keyVarNames, keep));
+}
+
+// -----------------------------------------------------------------------------
+
+class ObsSpaceOutputSelection : public oops::Test {
+ private:
+  std::string testid() const override {return "test::ObsSpaceOutputSelection";}
+
+  void register_tests() const override {}
+
+  void clear() const override {}
+};
+
+// -----------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace ioda
+
+#endif  // TEST_IODA_OBSSPACEOUTPUTSELECTION_H_
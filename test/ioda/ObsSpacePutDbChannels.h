@@ -50,6 +50,14 @@ CASE("ioda/ObsSpace/testPutDb") {
     bool createFile = testconf.getBool("create file", true);
     const Dimensions_t expectedNlocs = testconf.getUnsigned("expected nlocs", 0);
     const Dimensions_t expectedNchans = testconf.getUnsigned("expected nchans", 0);
+    // Save the obs space before the put_db calls too, so that the second save writes only
+    // the new variables if the obsdataout "incremental save" option is set.
+    const bool saveBeforePutDb = testconf.getBool("save before put_db", false);
+    // Check the variable written by the first save and then changed in the file; the change
+    // is kept only if the second save updates the file rather than rewriting it.
+    const bool checkTampered = testconf.getBool("check tampered variable", false);
+    const std::string fileName =
+        uniquifyFileName(obsconf.getString("obsdataout.engine.obsfile"), 0, -1);
 
     if (createFile) {
       // Create a ioda file which will be checked on a future invocation of this
@@ -66,6 +74,24 @@ CASE("ioda/ObsSpace/testPutDb") {
       std::vector<float> testVec1(nlocs), testVec2(nlocs);
       std::iota(testVec1.begin(), testVec1.end(), testVec1Start);
       std::iota(testVec2.begin(), testVec2.end(), testVec2Start);
+
+      if (saveBeforePutDb) {
+        // DummyGroup/single_dimensional_var is overwritten below after being saved, whereas
+        // DummyGroup/saved_once is not modified again.
+        obsspace->put_db("DummyGroup", "single_dimensional_var", testVec2);
+        obsspace->put_db("DummyGroup", "saved_once", testVec1);
+        obsspace->save();
+
+        // Change the file contents of DummyGroup/saved_once. A full rewrite of the file by
+        // the next save would restore the values held by the obs space.
+        if (obsspace->comm().rank() == 0) {
+          ioda::Group group = ioda::Engines::HH::openFile(
+                fileName, ioda::Engines::BackendOpenModes::Read_Write);
+          group.vars.open("DummyGroup/saved_once").write(testVec2);
+        }
+        obsspace->comm().barrier();
+      }
+
       obsspace->put_db("DummyGroup", "multi_dimensional_var_2", testVec1);
       obsspace->put_db("DummyGroup", "multi_dimensional_var_4", testVec2);
       obsspace->put_db("MetaData", "single_dimensional_var_2", testVec1);
@@ -84,8 +110,6 @@ CASE("ioda/ObsSpace/testPutDb") {
       obsspace->save();
     } else {
       // Read the output file and check that its contents are correct
-      const std::string fileName =
-          uniquifyFileName(obsconf.getString("obsdataout.engine.obsfile"), 0, -1);
       const ioda::Group group = ioda::Engines::HH::openFile(
             fileName, ioda::Engines::BackendOpenModes::Read_Only);
 
@@ -161,6 +185,12 @@ CASE("ioda/ObsSpace/testPutDb") {
         EXPECT_EQUAL(values, testVec1);
       }
 
+      if (checkTampered) {
+        const std::vector<float> values =
+            group.vars.open("DummyGroup/saved_once").readAsVector<float>();
+        EXPECT_EQUAL(values, testVec2);
+      }
+
       {
         const Variable var = group.vars.open("MetaData/single_dimensional_var_2");
         const Dimensions dims = var.getDimensions();
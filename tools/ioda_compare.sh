@@ -7,6 +7,7 @@
 # argument 3: the filename to test
 # argument 4: tolerence for comparing values
 # argument 5: verbosity
+# argument 6: the reference file name (defaults to argument 3)
 
 set -eu
 
@@ -15,6 +16,7 @@ cmd=$2
 file_name=$3
 tol=${4:-"0.0"}
 verbose=${5:-${VERBOSE:-"N"}}
+ref_file_name=${6:-$file_name}
 
 [[ $verbose =~ 'yYtT' ]] && set -x
 
@@ -24,7 +26,7 @@ case $file_type in
   hdf5)
     $cmd
     set +e
-    h5diff -v testoutput/$file_name $testRefDir/$file_name
+    h5diff -v testoutput/$file_name $testRefDir/$ref_file_name
     rc=${?}
     if [[ $rc != 0 ]]; then
       h5dump testoutput/$file_name
@@ -33,12 +35,12 @@ case $file_type in
     ;;
   netcdf)
     $cmd && \
-    nccmp testoutput/$file_name $testRefDir/$file_name -d -m -g -f -S -T ${tol}
+    nccmp testoutput/$file_name $testRefDir/$ref_file_name -d -m -g -f -S -T ${tol}
     rc=${?}
     ;;
    odb)
     $cmd && \
-    odc compare testoutput/$file_name $testRefDir/$file_name
+    odc compare testoutput/$file_name $testRefDir/$ref_file_name
     rc=${?}
     ;;
    *)